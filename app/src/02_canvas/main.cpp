@@ -1,7 +1,6 @@
 #include "canvas.h"
 #include "tuple.h"
 #include <cstdint>
-#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -16,11 +15,7 @@ struct Environment {
 };
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 Projectal tick(Environment env, Projectal proj) {
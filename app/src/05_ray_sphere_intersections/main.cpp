@@ -5,17 +5,12 @@
 #include "transformations.h"
 #include "tuple.h"
 #include <cstdint>
-#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 int main() {
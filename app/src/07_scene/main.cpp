@@ -7,15 +7,10 @@
 #include "tuple.h"
 #include "world.h"
 #include <cmath>
-#include <fstream>
 #include <memory>
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 int main() {
@@ -72,6 +67,6 @@ int main() {
   Camera camera(100, 50, M_PI / 3);
   camera.transform() = view(Point(0, 1.5, -5), Point(0, 1, 0), Vector(0, 1, 0));
 
-  Canvas canvas = camera.render(w);
+  Canvas canvas = camera.render(w, RenderOptions{});
   writeToFile(canvas, "scene_02.ppm");
 }
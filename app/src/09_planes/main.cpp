@@ -8,16 +8,11 @@
 #include "tuple.h"
 #include "world.h"
 #include <cmath>
-#include <fstream>
 #include <iostream>
 #include <memory>
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 int main() {
@@ -84,6 +79,6 @@ int main() {
       view(Point(5, 2.5, -5), Point(-3, 2.2f, 0), Vector(0, 1, 0));
 
   std::cout << "hsize: " << camera.hsize() << "\nvsize: " << camera.vsize();
-  Canvas canvas = camera.render(w);
+  Canvas canvas = camera.render(w, RenderOptions{});
   writeToFile(canvas, "plane.ppm");
 }
@@ -8,16 +8,11 @@
 #include "tuple.h"
 #include "world.h"
 #include <cmath>
-#include <fstream>
 #include <iostream>
 #include <memory>
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 int main() {
@@ -132,6 +127,6 @@ int main() {
   Camera camera(1300, 600, M_PI / 3.f);
   camera.transform() = view(Point(0, 1.5, -5), Point(0, 1, 0), Vector(0, 1, 0));
 
-  Canvas canvas = camera.render(w);
+  Canvas canvas = camera.render(w, RenderOptions{});
   writeToFile(canvas, "patterns.ppm");
 }
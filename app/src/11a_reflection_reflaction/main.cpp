@@ -9,16 +9,11 @@
 #include "tuple.h"
 #include "world.h"
 #include <cmath>
-#include <fstream>
 #include <iostream>
 #include <memory>
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 int main() {
@@ -165,6 +160,6 @@ int main() {
   camera.transform() =
       view(Point(0.5, 2.f, -8.f), Point(0, 1.75f, 0), Vector(0, 1, 0));
 
-  Canvas canvas = camera.render(w);
+  Canvas canvas = camera.render(w, RenderOptions{});
   writeToFile(canvas, "reflection_reflaction.ppm");
 }
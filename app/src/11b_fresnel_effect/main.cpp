@@ -7,15 +7,10 @@
 #include "transformations.h"
 #include "tuple.h"
 #include "world.h"
-#include <fstream>
 #include <memory>
 
 void writeToFile(const Canvas &c, std::string filename) {
-  const auto ppm = c.getAsPPM();
-  std::ofstream ppmfile;
-  ppmfile.open(filename);
-  ppmfile << ppm;
-  ppmfile.close();
+  c.savePPM(filename);
 }
 
 int main() {
@@ -100,6 +95,6 @@ int main() {
   camera.transform() =
       view(Point(0.f, 1.f, -3.5f), Point(0.f, 0.f, 5.f), Vector(0.f, 1.f, 0.f));
 
-  Canvas canvas = camera.render(world);
+  Canvas canvas = camera.render(world, RenderOptions{});
   writeToFile(canvas, "fresnel_effect.ppm");
 }
@@ -0,0 +1,61 @@
+#include "camera.h"
+#include "checkpoint.h"
+#include "scene.h"
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+void usage() {
+  std::cerr << "usage: render <scene> <output> [--threads n] "
+               "[--checkpoint path [--resume]]\n"
+               "  the output format follows the extension: .ppm, .qoi, "
+               ".png or .pfm\n";
+}
+} // namespace
+
+int main(int argc, char **argv) try {
+  std::string scenePath, outputPath, checkpointPath;
+  RenderOptions options;
+  bool resume = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc) {
+      options.threads = uint32_t(std::stoul(argv[++i]));
+    } else if (arg == "--checkpoint" && i + 1 < argc) {
+      checkpointPath = argv[++i];
+    } else if (arg == "--resume") {
+      resume = true;
+    } else if (scenePath.empty()) {
+      scenePath = arg;
+    } else if (outputPath.empty()) {
+      outputPath = arg;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (outputPath.empty() || (resume && checkpointPath.empty()) ||
+      options.threads == 0) {
+    usage();
+    return 2;
+  }
+
+  const Scene scene = loadScene(scenePath);
+  const auto &camera = scene.camera;
+  if (checkpointPath.empty()) {
+    camera.render(scene.world, options).save(outputPath);
+  } else {
+    // the checkpoint is kept after the output is written, a later --resume
+    // of the same scene finds nothing left to do
+    Checkpoint checkpoint(checkpointPath, camera.hsize(), camera.vsize(),
+                          options.tileSize, resume);
+    camera.render(scene.world, options, checkpoint);
+    checkpoint.image().save(outputPath);
+  }
+  return 0;
+} catch (const std::exception &e) {
+  std::cerr << "render: " << e.what() << '\n';
+  return 1;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "matrix.h"
+#include "tuple.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Axis-aligned bounding box. A default constructed box is empty; a box with
+// any infinite extent describes an unbounded shape (e.g. a plane).
+struct BoundingBox {
+  BoundingBox()
+      : min(Point(std::numeric_limits<float>::infinity(),
+                  std::numeric_limits<float>::infinity(),
+                  std::numeric_limits<float>::infinity())),
+        max(Point(-std::numeric_limits<float>::infinity(),
+                  -std::numeric_limits<float>::infinity(),
+                  -std::numeric_limits<float>::infinity())) {}
+  BoundingBox(const point_t &min, const point_t &max) : min(min), max(max) {}
+
+  static BoundingBox infinite() {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    return BoundingBox(Point(-inf, -inf, -inf), Point(inf, inf, inf));
+  }
+
+  bool isEmpty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+  }
+
+  bool isInfinite() const {
+    return !isEmpty() &&
+           (std::isinf(min.x) || std::isinf(min.y) || std::isinf(min.z) ||
+            std::isinf(max.x) || std::isinf(max.y) || std::isinf(max.z));
+  }
+
+  void extend(const point_t &p) {
+    min = Point(std::min(min.x, p.x), std::min(min.y, p.y),
+                std::min(min.z, p.z));
+    max = Point(std::max(max.x, p.x), std::max(max.y, p.y),
+                std::max(max.z, p.z));
+  }
+
+  void extend(const BoundingBox &other) {
+    if (other.isEmpty())
+      return;
+    extend(other.min);
+    extend(other.max);
+  }
+
+  point_t centroid() const {
+    return Point((min.x + max.x) * .5f, (min.y + max.y) * .5f,
+                 (min.z + max.z) * .5f);
+  }
+
+  float extent(int axis) const {
+    return axis == 0   ? max.x - min.x
+           : axis == 1 ? max.y - min.y
+                       : max.z - min.z;
+  }
+
+  float surfaceArea() const {
+    if (isEmpty())
+      return 0.f;
+    const float dx = max.x - min.x;
+    const float dy = max.y - min.y;
+    const float dz = max.z - min.z;
+    return 2.f * (dx * dy + dy * dz + dz * dx);
+  }
+
+  bool contains(const point_t &p) const {
+    return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y &&
+           p.z >= min.z && p.z <= max.z;
+  }
+
+  // box enclosing all eight transformed corners
+  BoundingBox transform(const Mat44 &m) const {
+    if (isEmpty() || isInfinite())
+      return *this;
+    BoundingBox result;
+    for (int i = 0; i < 8; ++i) {
+      const point_t corner = Point(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y,
+                                   i & 4 ? max.z : min.z);
+      result.extend(m.transformPoint(corner));
+    }
+    return result;
+  }
+
+  // slab test against the ray origin + t * direction for t in [tMin, tMax];
+  // invDirection holds the per component reciprocals of the direction
+  bool intersects(const point_t &origin, const vector_t &invDirection,
+                  float tMin, float tMax) const {
+    const float tx1 = (min.x - origin.x) * invDirection.x;
+    const float tx2 = (max.x - origin.x) * invDirection.x;
+    tMin = std::max(tMin, std::min(tx1, tx2));
+    tMax = std::min(tMax, std::max(tx1, tx2));
+
+    const float ty1 = (min.y - origin.y) * invDirection.y;
+    const float ty2 = (max.y - origin.y) * invDirection.y;
+    tMin = std::max(tMin, std::min(ty1, ty2));
+    tMax = std::min(tMax, std::max(ty1, ty2));
+
+    const float tz1 = (min.z - origin.z) * invDirection.z;
+    const float tz2 = (max.z - origin.z) * invDirection.z;
+    tMin = std::max(tMin, std::min(tz1, tz2));
+    tMax = std::min(tMax, std::max(tz1, tz2));
+
+    return tMin <= tMax;
+  }
+
+  bool operator==(const BoundingBox &other) const {
+    return min == other.min && max == other.max;
+  }
+
+  point_t min;
+  point_t max;
+};
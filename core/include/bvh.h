@@ -0,0 +1,199 @@
+#pragma once
+
+#include "bounding_box.h"
+#include "simd.h"
+#include "sphere_block.h"
+#include "tuple.h"
+#include "types.h"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Bounding volume hierarchy over the bounded objects of a scene, built with
+// the surface area heuristic and stored as a flat depth-first node array.
+// Objects without finite bounds (e.g. planes) are kept in a separate list
+// that is tested for every ray. The spheres of a leaf are additionally packed
+// into a SphereBlock, so single rays can test them together.
+class BVH {
+public:
+  void build(const std::vector<ShapePtr> &objects);
+  void clear();
+
+  size_t nodeCount() const { return nodes_.size(); }
+  const std::vector<SphereBlock> &blocks() const { return blocks_; }
+  const std::vector<ShapePtr> &bounded() const { return primitives_; }
+  const std::vector<ShapePtr> &unbounded() const { return unbounded_; }
+
+  // calls visit(shape, tMax) for every unbounded object and for every
+  // bounded object whose world space box is entered by origin + t * direction
+  // for some t in [tMin, tMax]. The visitor may lower tMax to cull the
+  // remaining nodes; traversal ends once tMax drops below tMin.
+  template <typename Visitor>
+  void traverse(const point_t &origin, const vector_t &direction, float tMin,
+                float tMax, Visitor &&visit) const {
+    traverse(origin, direction, tMin, tMax, visit, nullptr);
+  }
+
+  // same as above, but the spheres packed into the block of a leaf are
+  // handed to visitBlock(block, tMax) at once instead of to visit()
+  template <typename Visitor, typename BlockVisitor>
+  void traverse(const point_t &origin, const vector_t &direction, float tMin,
+                float tMax, Visitor &&visit, BlockVisitor &&visitBlock) const;
+
+  // four ray version of traverse() for t in [0, tMax[lane]]: calls
+  // visit(shape) for every unbounded object and for every bounded object
+  // whose box is entered by at least one of the rays. tMax is read again
+  // after every visit, so the visitor may lower it through the reference.
+  template <typename Visitor>
+  void traverse(const Float4 (&origin)[3], const Float4 (&direction)[3],
+                const float (&tMax)[4], Visitor &&visit) const;
+
+private:
+  struct Node {
+    BoundingBox box;
+    // first primitive for leaves, index of the second child otherwise
+    // (the first child always directly follows its parent)
+    uint32_t offset;
+    // number of primitives, 0 for interior nodes
+    uint32_t count;
+    // block holding the leading spheres of a leaf, s_noBlock if there is none
+    uint32_t block;
+    uint8_t axis;
+  };
+
+  static constexpr uint32_t s_noBlock = std::numeric_limits<uint32_t>::max();
+
+  struct BuildItem;
+
+  uint32_t buildNode(std::vector<BuildItem> &items, size_t begin, size_t end,
+                     uint32_t depth);
+
+  static constexpr uint32_t s_maxDepth = 48;
+
+  std::vector<Node> nodes_;
+  std::vector<ShapePtr> primitives_;
+  std::vector<ShapePtr> unbounded_;
+  std::vector<SphereBlock> blocks_;
+};
+
+template <typename Visitor, typename BlockVisitor>
+void BVH::traverse(const point_t &origin, const vector_t &direction,
+                   float tMin, float tMax, Visitor &&visit,
+                   BlockVisitor &&visitBlock) const {
+  constexpr bool useBlocks =
+      !std::is_same_v<std::decay_t<BlockVisitor>, std::nullptr_t>;
+
+  for (const auto &shape : unbounded_) {
+    visit(shape, tMax);
+    if (tMax < tMin) {
+      return;
+    }
+  }
+  if (nodes_.empty()) {
+    return;
+  }
+
+  const vector_t invDirection =
+      Vector(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+  const bool negative[3] = {direction.x < 0.f, direction.y < 0.f,
+                            direction.z < 0.f};
+
+  uint32_t stack[s_maxDepth + 2];
+  uint32_t top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node &node = nodes_[stack[--top]];
+    if (!node.box.intersects(origin, invDirection, tMin, tMax)) {
+      continue;
+    }
+    if (node.count > 0) {
+      uint32_t i = 0;
+      if constexpr (useBlocks) {
+        if (node.block != s_noBlock) {
+          const SphereBlock &block = blocks_[node.block];
+          visitBlock(block, tMax);
+          if (tMax < tMin) {
+            return;
+          }
+          i = block.size();
+        }
+      }
+      for (; i < node.count; ++i) {
+        visit(primitives_[node.offset + i], tMax);
+        if (tMax < tMin) {
+          return;
+        }
+      }
+      continue;
+    }
+    // push the far child first so the near one is visited next
+    const uint32_t first = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+    if (negative[node.axis]) {
+      stack[top++] = first;
+      stack[top++] = node.offset;
+    } else {
+      stack[top++] = node.offset;
+      stack[top++] = first;
+    }
+  }
+}
+
+template <typename Visitor>
+void BVH::traverse(const Float4 (&origin)[3], const Float4 (&direction)[3],
+                   const float (&tMax)[4], Visitor &&visit) const {
+  for (const auto &shape : unbounded_) {
+    visit(shape);
+  }
+  if (nodes_.empty()) {
+    return;
+  }
+
+  const Float4 one(1.f);
+  const Float4 invDirection[3] = {one / direction[0], one / direction[1],
+                                  one / direction[2]};
+  // children are ordered by the direction of the first ray
+  const bool negative[3] = {direction[0][0] < 0.f, direction[1][0] < 0.f,
+                            direction[2][0] < 0.f};
+
+  // per lane slab test, with the operand order of BoundingBox::intersects()
+  const auto entered = [&](const BoundingBox &box) {
+    const float lower[3] = {box.min.x, box.min.y, box.min.z};
+    const float upper[3] = {box.max.x, box.max.y, box.max.z};
+    Float4 t0(0.f);
+    Float4 t1 = Float4::load(tMax);
+    for (int axis = 0; axis < 3; ++axis) {
+      const Float4 ta =
+          (Float4(lower[axis]) - origin[axis]) * invDirection[axis];
+      const Float4 tb =
+          (Float4(upper[axis]) - origin[axis]) * invDirection[axis];
+      t0 = max(min(tb, ta), t0);
+      t1 = min(max(tb, ta), t1);
+    }
+    return (t0 <= t1).any();
+  };
+
+  uint32_t stack[s_maxDepth + 2];
+  uint32_t top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node &node = nodes_[stack[--top]];
+    if (!entered(node.box)) {
+      continue;
+    }
+    if (node.count > 0) {
+      for (uint32_t i = 0; i < node.count; ++i) {
+        visit(primitives_[node.offset + i]);
+      }
+      continue;
+    }
+    const uint32_t first = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+    if (negative[node.axis]) {
+      stack[top++] = first;
+      stack[top++] = node.offset;
+    } else {
+      stack[top++] = node.offset;
+      stack[top++] = first;
+    }
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "matrix.h"
+#include <cmath>
+
+// Forward transformation together with its inverse and inverse-transpose.
+// The derived matrices are recomputed lazily, only after the transformation
+// has been replaced through set() or handed out through the mutable accessor.
+class CachedTransform {
+public:
+  CachedTransform()
+      : matrix_(Mat44::identity()), inverse_(Mat44::identity()),
+        inverseTranspose_(Mat44::identity()) {}
+
+  const Mat44 &matrix() const { return matrix_; }
+
+  // the caller may modify the returned matrix, so the cache is invalidated;
+  // only by this call, the reference must not be kept for later writes
+  Mat44 &matrix() {
+    dirty_ = true;
+    return matrix_;
+  }
+
+  void set(const Mat44 &m) {
+    matrix_ = m;
+    dirty_ = true;
+  }
+
+  const Mat44 &inverse() const {
+    refresh();
+    return inverse_;
+  }
+
+  const Mat44 &inverseTranspose() const {
+    refresh();
+    return inverseTranspose_;
+  }
+
+  // scale factor s if the transformation is a similarity, i.e. its upper 3x3
+  // block is s times a rotation (or reflection), 0 otherwise
+  float uniformScale() const {
+    refresh();
+    return uniformScale_;
+  }
+
+private:
+  void refresh() const {
+    if (!dirty_)
+      return;
+    inverse_ = matrix_.inverse();
+    inverseTranspose_ = inverse_.transpose();
+    uniformScale_ = similarityScale(matrix_);
+    dirty_ = false;
+  }
+
+  static float similarityScale(const Mat44 &m) {
+    if (m(3, 0) != 0.f || m(3, 1) != 0.f || m(3, 2) != 0.f || m(3, 3) != 1.f)
+      return 0.f;
+    // the columns of a scaled rotation are orthogonal and of equal length
+    const auto dot = [&m](uint8_t i, uint8_t j) {
+      return m(0, i) * m(0, j) + m(1, i) * m(1, j) + m(2, i) * m(2, j);
+    };
+    const float lengthSq = dot(0, 0);
+    const float tolerance = 1e-5f * lengthSq;
+    if (std::abs(dot(1, 1) - lengthSq) > tolerance ||
+        std::abs(dot(2, 2) - lengthSq) > tolerance ||
+        std::abs(dot(0, 1)) > tolerance || std::abs(dot(0, 2)) > tolerance ||
+        std::abs(dot(1, 2)) > tolerance)
+      return 0.f;
+    return std::sqrt(lengthSq);
+  }
+
+  Mat44 matrix_;
+  mutable Mat44 inverse_;
+  mutable Mat44 inverseTranspose_;
+  mutable float uniformScale_{1.f};
+  mutable bool dirty_{false};
+};
@@ -2,8 +2,31 @@
 
 #include "canvas.h"
 #include "matrix.h"
+#include "parallel.h"
+#include "pixel_format.h"
 #include "ray.h"
+#include "simd.h"
+#include "tuple.h"
 #include <cstdint>
+#include <vector>
+
+class Checkpoint;
+class RowSink;
+struct RayPacket;
+
+struct RenderOptions {
+  // number of worker threads, 1 renders on the calling thread only
+  uint32_t threads = defaultThreadCount();
+  // edge length in pixels of the square tiles handed out to the workers
+  uint32_t tileSize = 16;
+  // trace the primary rays of 2x2 pixel blocks as one packet
+  bool packets = true;
+  // bands of tileSize rows the streaming render() keeps in memory; more
+  // bands let the workers run further ahead of a slow sink
+  uint32_t window = 4;
+  // storage of the image returned by render()
+  PixelFormat format = PixelFormat::RGB32F;
+};
 
 class Camera {
 public:
@@ -14,16 +37,73 @@ public:
   float fieldOfView() const { return fieldOfView_; }
   float pixelSize() const { return pixelSize_; }
 
-  Mat44 &transform() { return transform_; }
-  const Mat44 transform() const { return transform_; }
+  // the caller may modify the returned matrix, so the cached view is
+  // recomputed before the next ray is generated
+  Mat44 &transform() {
+    dirty_ = true;
+    return transform_;
+  }
+  const Mat44 &transform() const { return transform_; }
 
-  void setTransorm(const Mat44 &m) { transform_ = m; }
+  void setTransorm(const Mat44 &m) {
+    transform_ = m;
+    dirty_ = true;
+  }
 
   Ray rayForPixel(uint32_t x, uint32_t y) const;
 
+  // rays of the pixels [x0, x1) x [y0, y1) in row major order, the same rays
+  // as rayForPixel() but generated four at a time; rays is cleared first
+  void raysForTile(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1,
+                   std::vector<Ray> &rays) const;
+
+  // rays of four pixels in one packet, lane i is rayForPixel(xs[i], ys[i])
+  RayPacket packetForPixels(const uint32_t (&xs)[4],
+                            const uint32_t (&ys)[4]) const;
+
   Canvas render(const World &world) const;
 
+  // tile based render spread over options.threads workers, produces the same
+  // image as the serial render()
+  Canvas render(const World &world, const RenderOptions &options) const;
+  // the same into an existing canvas of hSize x vSize pixels, e.g. one
+  // mapped from a file with Canvas::createMappedPFM() for images larger than
+  // memory; options.format is ignored, throws std::invalid_argument if the
+  // size does not match
+  void render(const World &world, const RenderOptions &options,
+              Canvas &image) const;
+
+  // renders the tiles checkpoint has not finished yet into its image, which
+  // is saved periodically and once more at the end; the tile size comes from
+  // the checkpoint. Throws std::invalid_argument if its size does not match.
+  void render(const World &world, const RenderOptions &options,
+              Checkpoint &checkpoint) const;
+
+  // streaming render: every band of tileSize rows goes to sink as soon as it
+  // and the bands above it are done, while the workers trace the following
+  // ones; at most options.window bands are held in memory, the image as a
+  // whole never is
+  void render(const World &world, const RenderOptions &options,
+              RowSink &sink) const;
+
 private:
+  // recomputes the cached view if the transformation changed; render() calls
+  // it before the workers start, so they only ever read the cache
+  void refresh() const;
+
+  // traces the pixels [x0, x1) x [y0, y1), pixel (x, y) is written to
+  // pixels[(y - y0) * stride + x - x0]
+  void renderTile(const World &world, bool packets, uint32_t x0, uint32_t y0,
+                  uint32_t x1, uint32_t y1, Color *pixels,
+                  size_t stride) const;
+  // traces tile number tile of a tileSize grid into image
+  void renderTile(const World &world, bool packets, size_t tile,
+                  uint32_t tileSize, Canvas &image) const;
+
+  // normalized directions through the pixel centers (x, y) of every lane
+  void directions(Float4 x, Float4 y, Float4 &dx, Float4 &dy,
+                  Float4 &dz) const;
+
   uint32_t hSize_;
   uint32_t vSize_;
   float fieldOfView_;
@@ -31,4 +111,13 @@ private:
   float pixelSize_;
   float halfWidth_;
   float halfHeight_;
+
+  // world space view derived from the inverse transformation: the eye, the
+  // vector from the eye to the center of pixel (0, 0) and the steps between
+  // neighbouring pixel centers along a row and a column
+  mutable point_t origin_;
+  mutable vector_t toCorner_;
+  mutable vector_t stepX_;
+  mutable vector_t stepY_;
+  mutable bool dirty_{true};
 };
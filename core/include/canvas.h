@@ -1,4 +1,7 @@
+#pragma once
+
 #include "color.h"
+#include "pixel_format.h"
 #include <cstddef>
 #include <cstdint>
 #include <span>
@@ -6,9 +9,14 @@
 #include <string>
 #include <vector>
 
+class RowSink;
+
+// Image of width x height pixels, stored in the chosen PixelFormat; colors
+// are converted when they are written and read back.
 class Canvas {
 public:
-  Canvas(uint32_t width, uint32_t height);
+  Canvas(uint32_t width, uint32_t height,
+         PixelFormat format = PixelFormat::RGB32F);
   Canvas(Canvas const &other) = delete;
   Canvas(Canvas &&other);
 
@@ -16,13 +24,54 @@ public:
 
   uint32_t width() const;
   uint32_t height() const;
+  PixelFormat format() const { return format_; }
 
   void writePixel(size_t w, size_t h, Color color);
 
-  std::span<Color> pixels() const;
+  // consecutive pixels of row h starting at column w, converted in one go
+  void writePixels(size_t w, size_t h, std::span<const Color> colors);
+  void readPixels(size_t w, size_t h, std::span<Color> colors) const;
 
+  // plain (P3) PPM, readable but slow and large; meant for tests and small
+  // images
   std::string getAsPPM() const;
 
+  // the image from top to bottom into sink, begin() and end() included;
+  // SRGB8 canvases hand their bytes over as they are
+  void write(RowSink &sink) const;
+
+  // binary (P6) PPM streamed to fd row by row, with the same channel values
+  // as getAsPPM(); throws std::runtime_error if writing fails
+  void writePPM(int fd) const;
+  // writePPM() into the file at path, which is created or truncated
+  void savePPM(const std::string &path) const;
+  // portable float map (PFM) with the unclamped colors, for exposure and
+  // tone mapping after rendering; RGB32F rows are written straight from the
+  // canvas, bottom to top as the format stores them
+  void writePFM(int fd) const;
+  // reads a color (PF) or grayscale (Pf) float map in either byte order into
+  // an RGB32F canvas; throws std::runtime_error for malformed input
+  static Canvas readPFM(int fd);
+  static Canvas loadPFM(const std::string &path);
+
+  // RGB32F canvas backed by a memory mapped PFM file at path, which is
+  // created or truncated; pixels go straight into the page cache and the OS
+  // writes them back and evicts them, so the image does not have to fit
+  // into memory. The file is a complete PFM at any time, unwritten pixels
+  // are black.
+  static Canvas createMappedPFM(const std::string &path, uint32_t width,
+                                uint32_t height);
+  // maps an existing color PFM in the native byte order, e.g. to continue a
+  // render; throws std::runtime_error for other files
+  static Canvas openMappedPFM(const std::string &path);
+  bool isMapped() const { return mapping_ != nullptr; }
+  // writes the pixels of a mapped canvas back to its file, a no-op otherwise
+  void sync() const;
+
+  // the file at path in the format of its extension: .ppm (binary), .qoi,
+  // .png or .pfm; throws std::invalid_argument for any other extension
+  void save(const std::string &path) const;
+
   ~Canvas();
 
 private:
@@ -35,7 +84,22 @@ private:
   uint32_t writePPMColorComponent(std::ostringstream &oss, float value,
                                   uint32_t rowWidth) const;
 
-  Color *pixels_;
+  // maps the PFM file behind fd with the given header size
+  static Canvas map(int fd, uint32_t width, uint32_t height,
+                    size_t headerSize);
+
+  // byte offset of pixel (w, h), throws std::out_of_range if count pixels
+  // from there do not fit into row h
+  size_t offset(size_t w, size_t h, size_t count) const;
+  // first byte of row h, unchecked
+  uint8_t *row(size_t h) const;
+
+  uint8_t *pixels_;
   uint32_t width_;
   uint32_t height_;
+  PixelFormat format_;
+  // mapped canvases keep the rows bottom to top like the PFM file does
+  bool bottomUp_{false};
+  uint8_t *mapping_{nullptr};
+  size_t mappingSize_{0};
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "canvas.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Progress of a tile based render on disk, so a render that gets killed can
+// be resumed instead of started over. The image is a memory mapped PFM at
+// path (see Canvas::createMappedPFM()), the finished tiles are a bitmap in
+// path + ".tiles". Rendering with Camera::render() marks every tile once its
+// pixels are in the canvas and saves both files every interval.
+class Checkpoint {
+public:
+  // starts a new render of width x height pixels in tiles of tileSize, or
+  // with resume set continues the one at path; throws std::runtime_error if
+  // there is none or it was made for another image size or tile size
+  Checkpoint(const std::string &path, uint32_t width, uint32_t height,
+             uint32_t tileSize, bool resume,
+             std::chrono::milliseconds interval = std::chrono::seconds(60));
+  Checkpoint(const Checkpoint &) = delete;
+
+  Canvas &image() { return image_; }
+  uint32_t tileSize() const { return tileSize_; }
+  size_t tiles() const { return finished_.size(); }
+  // tiles still to be rendered, in row major order
+  std::vector<size_t> remaining() const;
+
+  // marks tile as rendered, saves the checkpoint if the last save is more
+  // than interval ago; may be called from several workers
+  void finish(size_t tile);
+
+  // flushes the image and then writes the bitmap, so the file never lists a
+  // tile whose pixels are not on disk yet
+  void save();
+
+private:
+  void write(const std::vector<uint8_t> &finished) const;
+  void read();
+  std::string header() const;
+
+  std::string path_;
+  uint32_t tileSize_;
+  Canvas image_;
+  std::chrono::milliseconds interval_;
+  std::mutex mutex_;
+  // one byte per tile, packed into bits on disk
+  std::vector<uint8_t> finished_;
+  std::chrono::steady_clock::time_point lastSave_;
+  bool saving_{false};
+};
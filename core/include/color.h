@@ -23,15 +23,27 @@ public:
 
   // Hadamard product example
   friend Color operator*(const Color &lhs, const Color &rhs) noexcept {
+#ifdef RAYTRACER_SSE
+    return Color(Tuple(_mm_mul_ps(lhs.simd(), rhs.simd())));
+#else
     return Color(lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z);
+#endif
   }
 
   friend Color operator+(const Color &lhs, const Color &rhs) noexcept {
+#ifdef RAYTRACER_SSE
+    return Color(Tuple(_mm_add_ps(lhs.simd(), rhs.simd())));
+#else
     return Color(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z);
+#endif
   }
 
   friend Color operator*(const Color &lhs, const float &rhs) noexcept {
+#ifdef RAYTRACER_SSE
+    return Color(Tuple(_mm_mul_ps(lhs.simd(), _mm_set1_ps(rhs))));
+#else
     return Color(lhs.x * rhs, lhs.y * rhs, lhs.z * rhs);
+#endif
   }
 
   static const Color &white() {
@@ -1,13 +1,14 @@
 #pragma once
 
 #include "color.h"
+#include "medium_stack.h"
 #include "tuple.h"
 #include "types.h"
 #include <cmath>
 
 struct ComputationData {
   float t;
-  ShapeConstPtr object;
+  const Shape *object;
   point_t point;
   vector_t eyeV;
   vector_t normalV;
@@ -17,6 +18,8 @@ struct ComputationData {
   vector_t reflectiveV;
   float n1;
   float n2;
+  // media the incoming ray travelled through
+  MediumStack media;
 };
 
 inline std::ostream &operator<<(std::ostream &os, const ComputationData &c) {
@@ -24,7 +27,7 @@ inline std::ostream &operator<<(std::ostream &os, const ComputationData &c) {
      << "  t: " << c.t << ",\n"
      << "  object: "
      << (c.object ? "Shape@" + std::to_string(
-                                   reinterpret_cast<uintptr_t>(c.object.get()))
+                                   reinterpret_cast<uintptr_t>(c.object))
                   : "null")
      << ",\n"
      << "  point: " << c.point << ",\n"
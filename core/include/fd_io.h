@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Blocking I/O on file descriptors that retries partial transfers and
+// interrupted calls; both throw std::runtime_error on failure.
+
+// writes all size bytes of data
+void writeAll(int fd, const void *data, size_t size);
+// reads exactly size bytes, running into the end of the file is an error
+void readAll(int fd, void *data, size_t size);
+
+// the whole file at path
+std::string readFile(const std::string &path);
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "scratch_arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+// Vector-like container that keeps up to N elements inside the object and
+// moves to the calling thread's ScratchArena once it grows beyond that. It is
+// meant for short lived lists on the render path; a buffer has to be
+// destroyed on the thread that filled it.
+template <typename T, size_t N> class InlineBuffer {
+public:
+  using value_type = T;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  InlineBuffer() : data_(inlineData()) {}
+
+  InlineBuffer(std::initializer_list<T> values) : InlineBuffer() {
+    reserve(values.size());
+    for (const auto &value : values)
+      push_back(value);
+  }
+
+  InlineBuffer(const InlineBuffer &other) : InlineBuffer() {
+    reserve(other.size_);
+    for (const auto &value : other)
+      push_back(value);
+  }
+
+  InlineBuffer(InlineBuffer &&other) noexcept : InlineBuffer() {
+    takeFrom(other);
+  }
+
+  InlineBuffer &operator=(const InlineBuffer &other) {
+    if (this != &other) {
+      clear();
+      reserve(other.size_);
+      for (const auto &value : other)
+        push_back(value);
+    }
+    return *this;
+  }
+
+  InlineBuffer &operator=(InlineBuffer &&other) noexcept {
+    if (this != &other) {
+      clear();
+      releaseStorage();
+      takeFrom(other);
+    }
+    return *this;
+  }
+
+  ~InlineBuffer() {
+    clear();
+    releaseStorage();
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+  // true while the elements still live inside the object
+  bool isInline() const { return arena_ == nullptr; }
+
+  T &operator[](size_t i) { return data_[i]; }
+  const T &operator[](size_t i) const { return data_[i]; }
+  T &front() { return data_[0]; }
+  const T &front() const { return data_[0]; }
+  T &back() { return data_[size_ - 1]; }
+  const T &back() const { return data_[size_ - 1]; }
+
+  T *data() { return data_; }
+  const T *data() const { return data_; }
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+  void reserve(size_t capacity) {
+    if (capacity > capacity_)
+      grow(capacity);
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  template <typename... Args> T &emplace_back(Args &&...args) {
+    if (size_ < capacity_) {
+      T *element = new (data_ + size_) T(std::forward<Args>(args)...);
+      ++size_;
+      return *element;
+    }
+    // the new element is built before the old ones are moved away, args may
+    // refer to one of them
+    ScratchArena &arena = storageArena();
+    const size_t capacity = size_t(capacity_) * 2;
+    T *data = allocate(arena, capacity);
+    T *element;
+    try {
+      element = new (data + size_) T(std::forward<Args>(args)...);
+    } catch (...) {
+      arena.release();
+      throw;
+    }
+    adopt(data, capacity, arena);
+    ++size_;
+    return *element;
+  }
+
+  // removes the element at pos and shifts the following ones down
+  iterator erase(const_iterator pos) {
+    T *it = data_ + (pos - data_);
+    for (T *next = it + 1; next != end(); ++next)
+      *(next - 1) = std::move(*next);
+    pop_back();
+    return it;
+  }
+
+  void pop_back() {
+    --size_;
+    data_[size_].~T();
+  }
+
+  void clear() {
+    for (size_t i = 0; i < size_; ++i)
+      data_[i].~T();
+    size_ = 0;
+  }
+
+private:
+  T *inlineData() { return reinterpret_cast<T *>(inline_); }
+
+  ScratchArena &storageArena() const {
+    return arena_ ? *arena_ : ScratchArena::local();
+  }
+
+  static T *allocate(ScratchArena &arena, size_t capacity) {
+    return static_cast<T *>(
+        arena.allocate(capacity * sizeof(T), alignof(T)));
+  }
+
+  void grow(size_t capacity) {
+    ScratchArena &arena = storageArena();
+    adopt(allocate(arena, capacity), capacity, arena);
+  }
+
+  // moves the elements into data, which came from arena
+  void adopt(T *data, size_t capacity, ScratchArena &arena) {
+    for (size_t i = 0; i < size_; ++i) {
+      new (data + i) T(std::move(data_[i]));
+      data_[i].~T();
+    }
+    releaseStorage();
+    data_ = data;
+    capacity_ = capacity;
+    arena_ = &arena;
+  }
+
+  void releaseStorage() {
+    if (arena_) {
+      arena_->release();
+      arena_ = nullptr;
+      data_ = inlineData();
+      capacity_ = N;
+    }
+  }
+
+  // expects an empty buffer with inline storage
+  void takeFrom(InlineBuffer &other) {
+    if (other.arena_) {
+      data_ = other.data_;
+      size_ = other.size_;
+      capacity_ = other.capacity_;
+      arena_ = other.arena_;
+      other.data_ = other.inlineData();
+      other.size_ = 0;
+      other.capacity_ = N;
+      other.arena_ = nullptr;
+      return;
+    }
+    for (size_t i = 0; i < other.size_; ++i)
+      new (data_ + i) T(std::move(other.data_[i]));
+    size_ = other.size_;
+    other.clear();
+  }
+
+  T *data_;
+  uint32_t size_{0};
+  uint32_t capacity_{N};
+  ScratchArena *arena_{nullptr};
+  alignas(T) std::byte inline_[N * sizeof(T)];
+};
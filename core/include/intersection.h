@@ -1,17 +1,20 @@
 #pragma once
 
+#include "inline_buffer.h"
 #include "types.h"
 #include <algorithm>
 #include <optional>
 #include <utility>
-#include <vector>
 
 class Intersection {
 public:
-  Intersection(float t, const ShapeConstPtr &s) : t_(t), shape_(s) {}
+  // the shape is not owned, the world keeps its objects alive while rays are
+  // traced through it
+  Intersection(float t, const Shape *s) : t_(t), shape_(s) {}
+  Intersection(float t, const ShapeConstPtr &s) : t_(t), shape_(s.get()) {}
 
   float t() const { return t_; }
-  ShapeConstPtr object() const { return shape_; }
+  const Shape *object() const { return shape_; }
 
   bool operator==(const Intersection &other) const {
     return t_ == other.t_ && shape_ == other.shape_;
@@ -21,36 +24,37 @@ public:
 
 private:
   float t_;
-  ShapeConstPtr shape_;
+  const Shape *shape_;
 };
 
-inline std::vector<Intersection> to_vector(const Intersection &s) {
-  return {s};
+// intersection lists are short, the two hits of a sphere plus whatever the
+// refraction setup needs fit without touching the allocator
+using IntersectionBuffer = InlineBuffer<Intersection, 8>;
+
+inline void append(IntersectionBuffer &xs, const Intersection &i) {
+  xs.push_back(i);
 }
 
-inline std::vector<Intersection>
-to_vector(const std::pair<Intersection, Intersection> &p) {
-  return {p.first, p.second};
+inline void append(IntersectionBuffer &xs,
+                   const std::pair<Intersection, Intersection> &p) {
+  xs.push_back(p.first);
+  xs.push_back(p.second);
 }
 
-inline std::vector<Intersection>
-to_vector(const std::optional<std::pair<Intersection, Intersection>> &p) {
+inline void
+append(IntersectionBuffer &xs,
+       const std::optional<std::pair<Intersection, Intersection>> &p) {
   if (p) {
-    return {p->first, p->second};
+    append(xs, *p);
   }
-  return {};
 }
 
 template <typename... Args>
-std::vector<Intersection> intersections(const Args &...args) {
-  std::vector<Intersection> xs;
-  (([&] {
-     for (auto &i : to_vector(args))
-       xs.push_back(i);
-   }()),
-   ...);
+IntersectionBuffer intersections(const Args &...args) {
+  IntersectionBuffer xs;
+  (append(xs, args), ...);
   std::sort(xs.begin(), xs.end());
   return xs;
 }
 
-std::optional<const Intersection> hit(const std::vector<Intersection> &xs);
+std::optional<const Intersection> hit(const IntersectionBuffer &xs);
@@ -24,7 +24,15 @@ private:
   Color intensity_;
 };
 
-Color lightining(const Material &material, const ShapeConstPtr &shape,
+Color lightining(const Material &material, const Shape *shape,
                  const PointLight &light, const point_t &position,
                  const vector_t &eyeVec, const vector_t &normalVec,
                  bool inShadow = false);
+
+inline Color lightining(const Material &material, const ShapeConstPtr &shape,
+                        const PointLight &light, const point_t &position,
+                        const vector_t &eyeVec, const vector_t &normalVec,
+                        bool inShadow = false) {
+  return lightining(material, shape.get(), light, position, eyeVec, normalVec,
+                    inShadow);
+}
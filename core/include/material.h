@@ -51,7 +51,7 @@ public:
   PatternPtr &pattern() { return pattern_; }
   void setPattern(const PatternPtr &pattern) { pattern_ = pattern; }
 
-  Color colorAt(const ShapeConstPtr &shape, const point_t &p) const {
+  Color colorAt(const Shape *shape, const point_t &p) const {
     return pattern_->colorAtObject(shape, p);
   }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "math.h"
+#include "simd.h"
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
@@ -43,10 +44,11 @@ public:
   operator*(const Matrix<OTHER_ROWS, OTHER_COLS> &other) const {
     Matrix<ROWS, OTHER_COLS> result{};
 
+    // indices are in range by construction, skip the checked accessors
     for (size_t i = 0; i < ROWS; ++i) {
       for (size_t j = 0; j < OTHER_COLS; ++j) {
         for (size_t k = 0; k < COLS; ++k) {
-          result(i, j) += (*this)(i, k) * other(k, j);
+          result.data_[i][j] += data_[i][k] * other.data_[k][j];
         }
       }
     }
@@ -54,11 +56,26 @@ public:
   }
 
   template <typename TupleT>
-    requires(COLS == 4)
+    requires(ROWS == 4 && COLS == 4)
   TupleT operator*(const TupleT &t) const {
-    return TupleT::fromMatrix((*this) * t.toMatrix());
+    const auto &a = data_;
+    return TupleT{
+        a[0][0] * t.x + a[0][1] * t.y + a[0][2] * t.z + a[0][3] * t.w,
+        a[1][0] * t.x + a[1][1] * t.y + a[1][2] * t.z + a[1][3] * t.w,
+        a[2][0] * t.x + a[2][1] * t.y + a[2][2] * t.z + a[2][3] * t.w,
+        a[3][0] * t.x + a[3][1] * t.y + a[3][2] * t.z + a[3][3] * t.w};
   }
 
+  // transformPoint() returns a Point and transformVector() a Vector, w of the
+  // input is not read. Neither reads the last row, which is only correct for
+  // affine matrices (isAffine()): transformPoint() asserts it, and every
+  // transformation built from transformations.h as well as its inverse (see
+  // CachedTransform) is affine. transformVector() only uses the upper 3x3
+  // block, so it also serves the inverse-transpose used for normals, whose
+  // last row holds the translation that a vector has to drop.
+  Tuple transformPoint(const Tuple &p) const;
+  Tuple transformVector(const Tuple &v) const;
+
   Matrix<COLS, ROWS> transpose() const {
     Matrix<COLS, ROWS> result{};
     for (size_t i = 0; i < ROWS; i++) {
@@ -89,6 +106,14 @@ public:
 
   Matrix<COLS, ROWS> inverse() const;
 
+  // true if the last row is exactly 0 0 0 1, as for every matrix built from
+  // transformations.h
+  bool isAffine() const;
+
+  // inverse of an affine matrix: inverts the upper 3x3 block and maps the
+  // translation through it
+  Matrix<4, 4> affineInverse() const;
+
   static Matrix identity() {
     static_assert(ROWS == COLS, "Identity matrix must be square");
     Matrix result{};
@@ -155,6 +180,8 @@ public:
   // }
 
 private:
+  template <uint8_t, uint8_t> friend class Matrix;
+
   float data_[ROWS][COLS];
 };
 
@@ -227,10 +254,11 @@ Matrix<ROWS - 1, COLS - 1> Matrix<ROWS, COLS>::submatrix(uint8_t row,
 
 template <uint8_t ROWS, uint8_t COLS>
 Matrix<COLS, ROWS> Matrix<ROWS, COLS>::inverse() const {
-  if (!isInvertible()) {
+  const float det = determinant();
+  if (det == 0.f) {
     throw std::runtime_error("Matrix is not invertible (determinant is zero)");
   }
-  const float invDet = 1.0f / determinant();
+  const float invDet = 1.0f / det;
   Matrix<COLS, ROWS> inverted;
   for (size_t i = 0; i < COLS; i++) {
     for (size_t j = 0; j < ROWS; j++) {
@@ -240,6 +268,139 @@ Matrix<COLS, ROWS> Matrix<ROWS, COLS>::inverse() const {
   return inverted;
 }
 
+template <>
+template <>
+inline Matrix<4, 4>
+Matrix<4, 4>::operator*<4, 4>(const Matrix<4, 4> &other) const {
+  Matrix<4, 4> result;
+#ifdef RAYTRACER_SSE
+  // every result row is a linear combination of the rows of other
+  const __m128 b0 = _mm_loadu_ps(other.data_[0]);
+  const __m128 b1 = _mm_loadu_ps(other.data_[1]);
+  const __m128 b2 = _mm_loadu_ps(other.data_[2]);
+  const __m128 b3 = _mm_loadu_ps(other.data_[3]);
+  for (size_t i = 0; i < 4; ++i) {
+    __m128 row = _mm_mul_ps(_mm_set1_ps(data_[i][0]), b0);
+    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(data_[i][1]), b1));
+    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(data_[i][2]), b2));
+    row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(data_[i][3]), b3));
+    _mm_storeu_ps(result.data_[i], row);
+  }
+#else
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      result.data_[i][j] =
+          data_[i][0] * other.data_[0][j] + data_[i][1] * other.data_[1][j] +
+          data_[i][2] * other.data_[2][j] + data_[i][3] * other.data_[3][j];
+    }
+  }
+#endif
+  return result;
+}
+
+// closed form determinant and inverse built from the 2x2 minors of the upper
+// and lower row pairs instead of the recursive cofactor expansion
+namespace detail {
+struct Minors44 {
+  explicit Minors44(const float (&a)[4][4])
+      : s0(a[0][0] * a[1][1] - a[1][0] * a[0][1]),
+        s1(a[0][0] * a[1][2] - a[1][0] * a[0][2]),
+        s2(a[0][0] * a[1][3] - a[1][0] * a[0][3]),
+        s3(a[0][1] * a[1][2] - a[1][1] * a[0][2]),
+        s4(a[0][1] * a[1][3] - a[1][1] * a[0][3]),
+        s5(a[0][2] * a[1][3] - a[1][2] * a[0][3]),
+        c0(a[2][0] * a[3][1] - a[3][0] * a[2][1]),
+        c1(a[2][0] * a[3][2] - a[3][0] * a[2][2]),
+        c2(a[2][0] * a[3][3] - a[3][0] * a[2][3]),
+        c3(a[2][1] * a[3][2] - a[3][1] * a[2][2]),
+        c4(a[2][1] * a[3][3] - a[3][1] * a[2][3]),
+        c5(a[2][2] * a[3][3] - a[3][2] * a[2][3]) {}
+
+  float determinant() const {
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  }
+
+  float s0, s1, s2, s3, s4, s5;
+  float c0, c1, c2, c3, c4, c5;
+};
+} // namespace detail
+
+template <> inline float Matrix<4, 4>::determinant() const {
+  return detail::Minors44(data_).determinant();
+}
+
+template <> inline bool Matrix<4, 4>::isAffine() const {
+  return data_[3][0] == 0.f && data_[3][1] == 0.f && data_[3][2] == 0.f &&
+         data_[3][3] == 1.f;
+}
+
+template <> inline Matrix<4, 4> Matrix<4, 4>::affineInverse() const {
+  const auto &a = data_;
+  const float c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+  const float c01 = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+  const float c02 = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+  const float det = a[0][0] * c00 + a[0][1] * c01 + a[0][2] * c02;
+  if (det == 0.f) {
+    throw std::runtime_error("Matrix is not invertible (determinant is zero)");
+  }
+  const float invDet = 1.f / det;
+
+  Matrix<4, 4> r;
+  auto &b = r.data_;
+  b[0][0] = c00 * invDet;
+  b[0][1] = (a[0][2] * a[2][1] - a[0][1] * a[2][2]) * invDet;
+  b[0][2] = (a[0][1] * a[1][2] - a[0][2] * a[1][1]) * invDet;
+  b[1][0] = c01 * invDet;
+  b[1][1] = (a[0][0] * a[2][2] - a[0][2] * a[2][0]) * invDet;
+  b[1][2] = (a[0][2] * a[1][0] - a[0][0] * a[1][2]) * invDet;
+  b[2][0] = c02 * invDet;
+  b[2][1] = (a[0][1] * a[2][0] - a[0][0] * a[2][1]) * invDet;
+  b[2][2] = (a[0][0] * a[1][1] - a[0][1] * a[1][0]) * invDet;
+  for (size_t i = 0; i < 3; ++i) {
+    b[i][3] = -(b[i][0] * a[0][3] + b[i][1] * a[1][3] + b[i][2] * a[2][3]);
+  }
+  b[3][0] = b[3][1] = b[3][2] = 0.f;
+  b[3][3] = 1.f;
+  return r;
+}
+
+template <> inline Matrix<4, 4> Matrix<4, 4>::inverse() const {
+  if (isAffine()) {
+    return affineInverse();
+  }
+
+  const auto &a = data_;
+  const detail::Minors44 m(a);
+  const float det = m.determinant();
+  if (det == 0.f) {
+    throw std::runtime_error("Matrix is not invertible (determinant is zero)");
+  }
+  const float invDet = 1.f / det;
+
+  Matrix<4, 4> r;
+  auto &b = r.data_;
+  b[0][0] = (a[1][1] * m.c5 - a[1][2] * m.c4 + a[1][3] * m.c3) * invDet;
+  b[0][1] = (-a[0][1] * m.c5 + a[0][2] * m.c4 - a[0][3] * m.c3) * invDet;
+  b[0][2] = (a[3][1] * m.s5 - a[3][2] * m.s4 + a[3][3] * m.s3) * invDet;
+  b[0][3] = (-a[2][1] * m.s5 + a[2][2] * m.s4 - a[2][3] * m.s3) * invDet;
+
+  b[1][0] = (-a[1][0] * m.c5 + a[1][2] * m.c2 - a[1][3] * m.c1) * invDet;
+  b[1][1] = (a[0][0] * m.c5 - a[0][2] * m.c2 + a[0][3] * m.c1) * invDet;
+  b[1][2] = (-a[3][0] * m.s5 + a[3][2] * m.s2 - a[3][3] * m.s1) * invDet;
+  b[1][3] = (a[2][0] * m.s5 - a[2][2] * m.s2 + a[2][3] * m.s1) * invDet;
+
+  b[2][0] = (a[1][0] * m.c4 - a[1][1] * m.c2 + a[1][3] * m.c0) * invDet;
+  b[2][1] = (-a[0][0] * m.c4 + a[0][1] * m.c2 - a[0][3] * m.c0) * invDet;
+  b[2][2] = (a[3][0] * m.s4 - a[3][1] * m.s2 + a[3][3] * m.s0) * invDet;
+  b[2][3] = (-a[2][0] * m.s4 + a[2][1] * m.s2 - a[2][3] * m.s0) * invDet;
+
+  b[3][0] = (-a[1][0] * m.c3 + a[1][1] * m.c1 - a[1][2] * m.c0) * invDet;
+  b[3][1] = (a[0][0] * m.c3 - a[0][1] * m.c1 + a[0][2] * m.c0) * invDet;
+  b[3][2] = (-a[3][0] * m.s3 + a[3][1] * m.s1 - a[3][2] * m.s0) * invDet;
+  b[3][3] = (a[2][0] * m.s3 - a[2][1] * m.s1 + a[2][2] * m.s0) * invDet;
+  return r;
+}
+
 using Mat44 = Matrix<4, 4>;
 using Mat33 = Matrix<3, 3>;
 using Mat22 = Matrix<2, 2>;
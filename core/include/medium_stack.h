@@ -0,0 +1,30 @@
+#pragma once
+
+#include "inline_buffer.h"
+#include <cstddef>
+
+class Shape;
+
+// Objects a ray currently travels through, the most recently entered last.
+// Refraction rays carry the stack of the surface they crossed, so the
+// refractive indices of a hit follow from the stack without looking at any
+// other intersection along the ray.
+class MediumStack {
+public:
+  MediumStack() = default;
+
+  bool empty() const { return objects_.empty(); }
+  size_t size() const { return objects_.size(); }
+  bool contains(const Shape *object) const;
+
+  // index of the innermost medium, 1 (vacuum) outside of every object
+  float refractiveIndex() const;
+  // refractiveIndex() after crossing the surface of object
+  float refractiveIndexAfter(const Shape *object) const;
+
+  // leaves object if the ray is inside of it, enters it otherwise
+  void cross(const Shape *object);
+
+private:
+  InlineBuffer<const Shape *, 4> objects_;
+};
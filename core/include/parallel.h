@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+inline uint32_t defaultThreadCount() {
+  const uint32_t n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1u;
+}
+
+// Runs task(i) for every i in [0, count) on `threads` workers. Each worker
+// starts with a contiguous block of indices and, once its own block is drained,
+// steals the upper half of the largest remaining block of another worker.
+// The first exception thrown by a task is rethrown after all workers joined.
+void parallelFor(size_t count, uint32_t threads,
+                 const std::function<void(size_t)> &task);
@@ -1,4 +1,5 @@
 #pragma once
+#include "cached_transform.h"
 #include "color.h"
 #include "matrix.h"
 #include "tuple.h"
@@ -7,19 +8,24 @@
 
 class Pattern {
 public:
-  Pattern() : transform_(Mat44::identity()) {}
+  Pattern() = default;
 
   virtual Color colorAt(const point_t &point) const = 0;
+  Color colorAtObject(const Shape *shape, const point_t &worldPoint) const;
   Color colorAtObject(const ShapeConstPtr &shape,
-                      const point_t &worldPoint) const;
+                      const point_t &worldPoint) const {
+    return colorAtObject(shape.get(), worldPoint);
+  }
   virtual bool operator==(const PatternPtr &other) const = 0;
 
-  const Mat44 &transformation() const { return transform_; }
-  Mat44 &transformation() { return transform_; }
-  void setTransformation(const Mat44 &transform) { transform_ = transform; }
+  const Mat44 &transformation() const { return transform_.matrix(); }
+  Mat44 &transformation() { return transform_.matrix(); }
+  void setTransformation(const Mat44 &transform) { transform_.set(transform); }
+
+  const Mat44 &inverseTransformation() const { return transform_.inverse(); }
 
 private:
-  Mat44 transform_;
+  CachedTransform transform_;
 };
 
 class SolidPattern : public Pattern {
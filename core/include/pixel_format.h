@@ -0,0 +1,44 @@
+#pragma once
+
+#include "color.h"
+#include <cstddef>
+#include <cstdint>
+
+// Storage layout of the pixels of a Canvas. Colors are display values, which
+// the image formats treat as sRGB encoded, so SRGB8 holds exactly the bytes
+// the 8 bit encoders write.
+enum class PixelFormat : uint8_t {
+  // three 32 bit floats, lossless
+  RGB32F,
+  // three IEEE 754 half floats, about three significant digits
+  RGB16F,
+  // three bytes, clamp(round(c * 255), 0, 255) per channel
+  SRGB8,
+};
+
+inline size_t bytesPerPixel(PixelFormat format) {
+  switch (format) {
+  case PixelFormat::RGB32F:
+    return 12;
+  case PixelFormat::RGB16F:
+    return 6;
+  case PixelFormat::SRGB8:
+    return 3;
+  }
+  return 0;
+}
+
+// count colors converted to format, bytesPerPixel(format) bytes each
+void encodePixels(PixelFormat format, const Color *colors, size_t count,
+                  uint8_t *bytes);
+// count pixels stored in format converted back to colors
+void decodePixels(PixelFormat format, const uint8_t *bytes, size_t count,
+                  Color *colors);
+
+// r, g and b of count colors as clamp(round(c * 255), 0, 255), three bytes
+// per color; NaN becomes 0
+void quantize(const Color *colors, size_t count, uint8_t *bytes);
+
+// IEEE 754 binary16 conversions, rounding to nearest even
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t half);
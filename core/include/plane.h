@@ -10,9 +10,17 @@ class Plane : public Shape {
 public:
   Plane() : Shape() {}
 
-  std::vector<Intersection> intersept(const Ray &ray) const override;
+  void localIntersept(const Ray &ray, IntersectionBuffer &xs) const override;
+
+  void localInterseptPacket(const RayPacket &rays,
+                            PacketHit &hits) const override;
+
+  bool interseptsBetween(const Ray &ray, float tMin,
+                         float tMax) const override;
 
   vector_t localNormalsAt(const point_t &objectPoint) const override;
 
+  BoundingBox bounds() const override;
+
   bool operator==(const Shape &other) const override;
 };
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "row_sink.h"
+#include <cstdint>
+#include <vector>
+
+// PNG encoder, 8 bit RGB without filtering. The zlib stream uses stored
+// (uncompressed) deflate blocks, so encoding is a copy plus the checksums;
+// every block goes out as its own IDAT chunk as soon as it is full.
+class PNGSink : public EncoderSink {
+public:
+  using EncoderSink::EncoderSink;
+
+  void writeQuantizedRows(uint32_t y, uint32_t count,
+                          const uint8_t *rgb) override;
+  void end() override;
+
+protected:
+  void writeHeader() override;
+
+private:
+  // writes one chunk: length, type, data and the CRC of type and data
+  void writeChunk(const char (&type)[5], const uint8_t *data, size_t size);
+  // turns block_ into a stored deflate block inside an IDAT chunk
+  void flushBlock(bool last);
+
+  std::vector<uint8_t> block_;
+  uint32_t adler_{1};
+  bool first_{true};
+};
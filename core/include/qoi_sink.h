@@ -0,0 +1,35 @@
+#pragma once
+
+#include "row_sink.h"
+#include <cstdint>
+#include <vector>
+
+// QOI ("Quite OK Image") encoder, three channels in sRGB. The format is a
+// single pass over the pixels with a 64 entry color cache, so it is encoded
+// while the rows arrive, with a bounded output buffer.
+class QOISink : public EncoderSink {
+public:
+  using EncoderSink::EncoderSink;
+
+  void writeQuantizedRows(uint32_t y, uint32_t count,
+                          const uint8_t *rgb) override;
+  void end() override;
+
+protected:
+  void writeHeader() override;
+
+private:
+  struct Pixel {
+    uint8_t r{0}, g{0}, b{0}, a{0};
+    bool operator==(const Pixel &other) const = default;
+  };
+
+  void flushRun();
+  // writes out buffer_ once it is nearly full
+  void reserve(size_t bytes);
+
+  Pixel previous_{0, 0, 0, 255};
+  Pixel index_[64];
+  uint32_t run_{0};
+  std::vector<uint8_t> buffer_;
+};
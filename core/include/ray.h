@@ -2,13 +2,13 @@
 
 #include "computation.h"
 #include "intersection.h"
+#include "medium_stack.h"
 #include "sphere.h"
 #include "tuple.h"
 #include "types.h"
 #include "world.h"
 #include <optional>
 #include <utility>
-#include <vector>
 
 class Ray {
 public:
@@ -20,15 +20,26 @@ public:
 
   point_t position(float t) const;
 
-  std::vector<Intersection> intersept(const ShapePtr &shape) const;
-  std::vector<Intersection> intersept(const World &world) const;
+  IntersectionBuffer intersept(const ShapePtr &shape) const;
+  IntersectionBuffer intersept(const World &world) const;
+
+  // nearest intersection with t > 0, same as hit(intersept(world)) but
+  // without collecting and sorting every intersection along the ray
+  std::optional<Intersection> closestHit(const World &world) const;
+
+  // true if a shadow casting object is hit for some t in (0, distance),
+  // returns on the first such object found
+  bool isOccluded(const World &world, float distance) const;
 
   Ray operator*(const Mat44 &m) const;
 
-  // ComputationData precompute(const Intersection &intersection) const;
-  ComputationData
-  precompute(const Intersection &intersection,
-             std::optional<std::vector<Intersection>> xs = std::nullopt) const;
+  // media holds the objects the ray travels through, n1 and n2 are derived
+  // from it and the object hit
+  ComputationData precompute(const Intersection &intersection,
+                             const MediumStack &media = {}) const;
+  // media are reconstructed from the intersections in xs preceding the hit
+  ComputationData precompute(const Intersection &intersection,
+                             const IntersectionBuffer &xs) const;
 
 private:
   point_t origin_;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "matrix.h"
+#include "ray.h"
+#include "simd.h"
+#include "types.h"
+#include <limits>
+
+class World;
+
+// Nearest hit per lane of a RayPacket, object is null for lanes without hit.
+struct PacketHit {
+  PacketHit() {
+    for (int i = 0; i < s_size; ++i) {
+      t[i] = std::numeric_limits<float>::infinity();
+      object[i] = nullptr;
+    }
+  }
+
+  // takes t for the lanes in mask
+  void update(Mask4 mask, Float4 t, const Shape *object);
+
+  static constexpr int s_size = 4;
+
+  alignas(16) float t[s_size];
+  const Shape *object[s_size];
+};
+
+// Four rays in structure of arrays layout, one SIMD lane per ray. Packets are
+// meant for coherent rays such as the primary rays of neighbouring pixels;
+// lanes that are not needed should repeat one of the other rays.
+struct RayPacket {
+  static constexpr int s_size = 4;
+
+  RayPacket(Float4 ox, Float4 oy, Float4 oz, Float4 dx, Float4 dy, Float4 dz)
+      : ox(ox), oy(oy), oz(oz), dx(dx), dy(dy), dz(dz) {}
+  explicit RayPacket(const Ray (&rays)[s_size]);
+
+  Ray ray(int lane) const {
+    return Ray(Point(ox[lane], oy[lane], oz[lane]),
+               Vector(dx[lane], dy[lane], dz[lane]));
+  }
+
+  RayPacket operator*(const Mat44 &m) const;
+
+  // same hits as Ray::closestHit() for every lane
+  PacketHit closestHits(const World &world) const;
+
+  Float4 ox, oy, oz;
+  Float4 dx, dy, dz;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "color.h"
+#include <cstdint>
+#include <vector>
+
+// Receives an image from top to bottom, a band of complete rows at a time,
+// so it can be written out while the rest is still being rendered.
+class RowSink {
+public:
+  virtual ~RowSink() = default;
+
+  // called once before the first rows
+  void begin(uint32_t width, uint32_t height) {
+    width_ = width;
+    height_ = height;
+    writeHeader();
+  }
+
+  uint32_t width() const { return width_; }
+  uint32_t height() const { return height_; }
+
+  // rows [y, y + count) in row major order, width * count colors; calls come
+  // in order and never overlap
+  virtual void writeRows(uint32_t y, uint32_t count, const Color *pixels) = 0;
+  // the same for rows quantized like PixelFormat::SRGB8, three bytes per
+  // pixel; the default turns them back into colors for writeRows()
+  virtual void writeQuantizedRows(uint32_t y, uint32_t count,
+                                  const uint8_t *rgb);
+  // called once after the last rows
+  virtual void end() {}
+
+protected:
+  // called by begin() once width() and height() are known
+  virtual void writeHeader() {}
+
+private:
+  uint32_t width_{0};
+  uint32_t height_{0};
+};
+
+// Base of the 8 bit image file encoders, which write to a file descriptor
+// that stays owned by the caller. Colors are quantized a few rows at a time
+// and passed on to writeQuantizedRows(), so memory use does not grow with
+// the image. Throws std::runtime_error if writing fails.
+class EncoderSink : public RowSink {
+public:
+  explicit EncoderSink(int fd) : fd_(fd) {}
+
+  void writeRows(uint32_t y, uint32_t count, const Color *pixels) override;
+
+protected:
+  // writes all of data, see writeAll()
+  void write(const uint8_t *data, size_t size);
+  // appends the four bytes of value, most significant first
+  static void appendBigEndian(std::vector<uint8_t> &out, uint32_t value);
+
+private:
+  int fd_;
+  // quantized rows, reused between calls
+  std::vector<uint8_t> buffer_;
+};
+
+// Binary (P6) PPM.
+class PPMSink : public EncoderSink {
+public:
+  using EncoderSink::EncoderSink;
+
+  void writeQuantizedRows(uint32_t y, uint32_t count,
+                          const uint8_t *rgb) override;
+
+protected:
+  void writeHeader() override;
+};
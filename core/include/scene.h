@@ -0,0 +1,42 @@
+#pragma once
+
+#include "camera.h"
+#include "world.h"
+#include <string>
+#include <string_view>
+
+// A world and the camera looking at it, described in a text file instead of
+// code. The format is a sequence of whitespace separated words, # starts a
+// comment that runs to the end of the line:
+//
+//   camera { width 640 height 480 fov 60 from 0 1.5 -5 to 0 1 0 up 0 1 0 }
+//   light { position -10 10 -10 intensity 1 1 1 }
+//   plane { material { pattern checker { a 1 1 1 b 0 0 0 } } }
+//   sphere {
+//     transform { translate 0 1 0 rotate-y 45 scale .5 .5 .5 }
+//     material { color 1 .2 .2 diffuse .7 specular .3 shininess 100 }
+//     shadow false
+//   }
+//
+// camera: width and height in pixels and fov in degrees are required, the
+//   view defaults to from 0 0 0 to 0 0 -1 up 0 1 0
+// light: position, intensity (default 1 1 1)
+// sphere, plane: transform, material and shadow (true or false)
+// transform: translate x y z, scale x y z, rotate-x/-y/-z degrees and
+//   shear xy xz yx yz zx zy, multiplied in the order they are written like
+//   translation(...) * rotationY(...) * scaling(...) in code
+// material: color r g b, pattern, ambient, diffuse, specular, shininess,
+//   reflective, transparency and refractive-index; missing fields keep the
+//   defaults of Material()
+// pattern: three numbers for a solid color, or one of stripe, gradient, ring,
+//   checker, radial-gradient and blend with the patterns a and b, or perlin
+//   with the perturbed pattern; all of them take an optional transform
+struct Scene {
+  World world;
+  Camera camera;
+};
+
+// builds the scene in a single pass over text; throws std::runtime_error
+// with the line number for malformed input
+Scene parseScene(std::string_view text);
+Scene loadScene(const std::string &path);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Per-thread bump allocator for short lived scratch memory (e.g. intersection
+// lists that outgrow their inline storage). Memory is never returned to the
+// system; once the last outstanding allocation has been released the arena
+// rewinds and the same blocks are handed out again, so a render loop settles
+// on a fixed set of blocks after the first few pixels.
+class ScratchArena {
+public:
+  ScratchArena() = default;
+  ScratchArena(const ScratchArena &) = delete;
+  ScratchArena &operator=(const ScratchArena &) = delete;
+
+  // arena of the calling thread
+  static ScratchArena &local();
+
+  void *allocate(size_t bytes, size_t alignment);
+
+  // marks one allocation as no longer used, the memory itself is only
+  // reclaimed when no allocation is outstanding anymore
+  void release();
+
+  size_t outstanding() const { return outstanding_; }
+  size_t reservedBytes() const;
+
+private:
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+  };
+
+  static constexpr size_t s_blockSize = 16 * 1024;
+
+  std::vector<Block> blocks_;
+  size_t block_{0};
+  size_t offset_{0};
+  size_t outstanding_{0};
+};
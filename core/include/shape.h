@@ -1,40 +1,95 @@
 #pragma once
 
+#include "bounding_box.h"
+#include "cached_transform.h"
+#include "intersection.h"
 #include "material.h"
 #include "matrix.h"
 #include "tuple.h"
-#include <vector>
-
 class Ray;
-class Intersection;
 class Material;
+struct RayPacket;
+struct PacketHit;
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
-class Shape : public std::enable_shared_from_this<Shape> {
+class Shape {
 public:
-  Shape() : transformation_(Mat44::identity()), material_(Material()) {}
+  Shape() : material_(Material()) {}
+
+  // intersections of the object space ray, collected into a fresh buffer
+  IntersectionBuffer intersept(const Ray &ray) const;
+
+  // appends the intersections of the object space ray to xs
+  virtual void localIntersept(const Ray &ray, IntersectionBuffer &xs) const = 0;
+
+  // lowers hits to the nearest t > 0 of every object space ray of the packet;
+  // the default intersects the rays one by one
+  virtual void localInterseptPacket(const RayPacket &rays,
+                                    PacketHit &hits) const;
 
-  virtual std::vector<Intersection> intersept(const Ray &ray) const = 0;
+  // true if the object space ray hits the shape for some t in (tMin, tMax);
+  // shapes override it to answer occlusion queries without collecting hits
+  virtual bool interseptsBetween(const Ray &ray, float tMin, float tMax) const;
+
+  // world space counterparts of localIntersept(), localInterseptPacket() and
+  // interseptsBetween(), the defaults transform the rays into object space
+  virtual void worldIntersept(const Ray &ray, IntersectionBuffer &xs) const;
+  virtual void worldInterseptPacket(const RayPacket &rays,
+                                    PacketHit &hits) const;
+  virtual bool worldInterseptsBetween(const Ray &ray, float tMin,
+                                      float tMax) const;
 
   virtual vector_t localNormalsAt(const point_t &objectPoint) const = 0;
 
+  // object space extent, shapes without finite bounds keep the default
+  virtual BoundingBox bounds() const { return BoundingBox::infinite(); }
+
+  bool isBounded() const { return !bounds().isInfinite(); }
+
+  // world space extent of bounds(), cached until the transformation changes
+  const BoundingBox &worldBounds() const {
+    if (!worldBoundsValid_) {
+      worldBounds_ = bounds().transform(transformation());
+      worldBoundsValid_ = true;
+    }
+    return worldBounds_;
+  }
+
   vector_t normalsAt(const point_t &worldPoint) const {
     if (!worldPoint.isPoint()) {
       throw std::invalid_argument("Sphere::normalsAt() expects a point as "
                                   "input, but a non-point value was provided.");
     }
-    const auto objectPoint = transformation().inverse() * worldPoint;
-    const auto objectNormal = localNormalsAt(objectPoint);
-    auto worldNormal = transformation().inverse().transpose() * objectNormal;
-    // hack - noramlly we should take transformation.submatrix(3,3)
-    worldNormal.w = 0.f;
-    return worldNormal.normalize();
+    return worldNormalsAt(worldPoint);
+  }
+
+  const Mat44 &transformation() const { return transformation_.matrix(); }
+  void setTransformation(const Mat44 &m) {
+    transformation_.set(m);
+    worldBoundsValid_ = false;
+    changed();
   }
 
-  Mat44 transformation() const { return transformation_; }
-  void setTransformation(const Mat44 &m) { transformation_ = m; }
+  // the caches (and the generation) are only invalidated by this call, so
+  // the returned reference must not be kept and written to later; use
+  // setTransformation() for shapes that were already rendered or bounded
+  Mat44 &transformation() {
+    worldBoundsValid_ = false;
+    changed();
+    return transformation_.matrix();
+  }
+
+  const Mat44 &inverseTransformation() const {
+    return transformation_.inverse();
+  }
+  const Mat44 &inverseTransposeTransformation() const {
+    return transformation_.inverseTranspose();
+  }
+  // scale factor of a similarity transformation, 0 for any other
+  float uniformScale() const { return transformation_.uniformScale(); }
 
-  Mat44 &transformation() { return transformation_; }
   const Material &material() const { return material_; }
 
   Material &material() { return material_; }
@@ -43,15 +98,47 @@ public:
 
   bool castShadows() const { return castsShadows_; }
 
-  void setCastsShadows(bool castShadows) { castsShadows_ = castShadows; }
+  void setCastsShadows(bool castShadows) {
+    castsShadows_ = castShadows;
+    changed();
+  }
+
+  // raised whenever the transformation or castShadows() may have changed, so
+  // copies of them (like the sphere blocks of a World's BVH) can be rebuilt;
+  // generations are unique over all shapes and only grow
+  uint64_t generation() const { return generation_; }
+  // the highest generation of any shape
+  static uint64_t latestGeneration() {
+    return s_generation.load(std::memory_order_relaxed);
+  }
 
   virtual bool operator==(const Shape &other) const {
     return transformation() == other.transformation() &&
            material() == other.material();
   }
 
+protected:
+  // normalized world space normal, shapes with a cheaper closed form for
+  // their world space normals override the transformation based default
+  virtual vector_t worldNormalsAt(const point_t &worldPoint) const {
+    const auto objectPoint = inverseTransformation().transformPoint(worldPoint);
+    const auto objectNormal = localNormalsAt(objectPoint);
+    const auto worldNormal =
+        inverseTransposeTransformation().transformVector(objectNormal);
+    return worldNormal.normalize();
+  }
+
 private:
-  Mat44 transformation_;
+  void changed() {
+    generation_ = s_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  inline static std::atomic<uint64_t> s_generation{0};
+
+  CachedTransform transformation_;
+  mutable BoundingBox worldBounds_;
+  mutable bool worldBoundsValid_{false};
   Material material_;
   bool castsShadows_{true};
+  uint64_t generation_{0};
 };
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <cmath>
+
+// RAYTRACER_SIMD is set by the build (option of the same name); without it,
+// or on targets without SSE2, the portable scalar code paths are used.
+#if defined(RAYTRACER_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define RAYTRACER_SSE 1
+#include <immintrin.h>
+// eight wide registers need the target enabled as well (RAYTRACER_AVX2)
+#if defined(__AVX2__)
+#define RAYTRACER_AVX 1
+#endif
+#endif
+
+struct Mask4;
+
+// Four floats processed in lockstep, e.g. one lane per ray of a packet.
+struct alignas(16) Float4 {
+  Float4() = default;
+  // broadcasts value to every lane
+  Float4(float value);
+  Float4(float a, float b, float c, float d);
+
+  // p has to be 16 byte aligned
+  static Float4 load(const float *p);
+  void store(float *p) const;
+
+  float operator[](int lane) const;
+
+#ifdef RAYTRACER_SSE
+  explicit Float4(__m128 v) : v(v) {}
+  __m128 v;
+#else
+  float v[4];
+#endif
+};
+
+// per lane result of a Float4 comparison
+struct alignas(16) Mask4 {
+  bool operator[](int lane) const;
+  // true if at least one lane is set
+  bool any() const;
+
+#ifdef RAYTRACER_SSE
+  explicit Mask4(__m128 v) : v(v) {}
+  __m128 v;
+#else
+  Mask4(bool a, bool b, bool c, bool d) : v{a, b, c, d} {}
+  bool v[4];
+#endif
+};
+
+#ifdef RAYTRACER_SSE
+
+inline Float4::Float4(float value) : v(_mm_set1_ps(value)) {}
+inline Float4::Float4(float a, float b, float c, float d)
+    : v(_mm_setr_ps(a, b, c, d)) {}
+
+inline Float4 Float4::load(const float *p) { return Float4(_mm_load_ps(p)); }
+inline void Float4::store(float *p) const { _mm_store_ps(p, v); }
+
+inline float Float4::operator[](int lane) const {
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, v);
+  return lanes[lane];
+}
+
+inline bool Mask4::operator[](int lane) const {
+  return (_mm_movemask_ps(v) >> lane) & 1;
+}
+inline bool Mask4::any() const { return _mm_movemask_ps(v) != 0; }
+
+inline Float4 operator+(Float4 a, Float4 b) {
+  return Float4(_mm_add_ps(a.v, b.v));
+}
+inline Float4 operator-(Float4 a, Float4 b) {
+  return Float4(_mm_sub_ps(a.v, b.v));
+}
+inline Float4 operator*(Float4 a, Float4 b) {
+  return Float4(_mm_mul_ps(a.v, b.v));
+}
+inline Float4 operator/(Float4 a, Float4 b) {
+  return Float4(_mm_div_ps(a.v, b.v));
+}
+inline Float4 operator-(Float4 a) {
+  return Float4(_mm_sub_ps(_mm_setzero_ps(), a.v));
+}
+inline Float4 sqrt(Float4 a) { return Float4(_mm_sqrt_ps(a.v)); }
+inline Float4 abs(Float4 a) {
+  return Float4(_mm_andnot_ps(_mm_set1_ps(-0.f), a.v));
+}
+// a < b ? a : b and a > b ? a : b per lane, so b is returned if either is NaN
+inline Float4 min(Float4 a, Float4 b) { return Float4(_mm_min_ps(a.v, b.v)); }
+inline Float4 max(Float4 a, Float4 b) { return Float4(_mm_max_ps(a.v, b.v)); }
+
+inline Mask4 operator<(Float4 a, Float4 b) {
+  return Mask4(_mm_cmplt_ps(a.v, b.v));
+}
+inline Mask4 operator<=(Float4 a, Float4 b) {
+  return Mask4(_mm_cmple_ps(a.v, b.v));
+}
+inline Mask4 operator>(Float4 a, Float4 b) {
+  return Mask4(_mm_cmpgt_ps(a.v, b.v));
+}
+inline Mask4 operator>=(Float4 a, Float4 b) {
+  return Mask4(_mm_cmpge_ps(a.v, b.v));
+}
+inline Mask4 operator&&(Mask4 a, Mask4 b) {
+  return Mask4(_mm_and_ps(a.v, b.v));
+}
+inline Mask4 operator||(Mask4 a, Mask4 b) {
+  return Mask4(_mm_or_ps(a.v, b.v));
+}
+inline Mask4 operator!(Mask4 a) {
+  return Mask4(_mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+}
+
+// lanes of a where mask is set, lanes of b elsewhere
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {
+  return Float4(
+      _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+}
+
+#else
+
+inline Float4::Float4(float value) : v{value, value, value, value} {}
+inline Float4::Float4(float a, float b, float c, float d) : v{a, b, c, d} {}
+
+inline Float4 Float4::load(const float *p) {
+  return Float4(p[0], p[1], p[2], p[3]);
+}
+inline void Float4::store(float *p) const {
+  for (int i = 0; i < 4; ++i)
+    p[i] = v[i];
+}
+
+inline float Float4::operator[](int lane) const { return v[lane]; }
+
+inline bool Mask4::operator[](int lane) const { return v[lane]; }
+inline bool Mask4::any() const { return v[0] || v[1] || v[2] || v[3]; }
+
+#define RAYTRACER_FLOAT4_OP(op)                                               \
+  inline Float4 operator op(Float4 a, Float4 b) {                             \
+    return Float4(a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2],       \
+                  a.v[3] op b.v[3]);                                          \
+  }
+#define RAYTRACER_MASK4_OP(op, type)                                          \
+  inline Mask4 operator op(type a, type b) {                                  \
+    return Mask4(a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2],        \
+                 a.v[3] op b.v[3]);                                           \
+  }
+
+RAYTRACER_FLOAT4_OP(+)
+RAYTRACER_FLOAT4_OP(-)
+RAYTRACER_FLOAT4_OP(*)
+RAYTRACER_FLOAT4_OP(/)
+RAYTRACER_MASK4_OP(<, Float4)
+RAYTRACER_MASK4_OP(<=, Float4)
+RAYTRACER_MASK4_OP(>, Float4)
+RAYTRACER_MASK4_OP(>=, Float4)
+RAYTRACER_MASK4_OP(&&, Mask4)
+RAYTRACER_MASK4_OP(||, Mask4)
+
+#undef RAYTRACER_FLOAT4_OP
+#undef RAYTRACER_MASK4_OP
+
+inline Float4 operator-(Float4 a) {
+  return Float4(-a.v[0], -a.v[1], -a.v[2], -a.v[3]);
+}
+inline Mask4 operator!(Mask4 a) {
+  return Mask4(!a.v[0], !a.v[1], !a.v[2], !a.v[3]);
+}
+inline Float4 sqrt(Float4 a) {
+  return Float4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]),
+                std::sqrt(a.v[3]));
+}
+inline Float4 abs(Float4 a) {
+  return Float4(std::abs(a.v[0]), std::abs(a.v[1]), std::abs(a.v[2]),
+                std::abs(a.v[3]));
+}
+// same operand order as minps / maxps, b is returned if either is NaN
+inline Float4 min(Float4 a, Float4 b) {
+  return Float4(a.v[0] < b.v[0] ? a.v[0] : b.v[0],
+                a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                a.v[2] < b.v[2] ? a.v[2] : b.v[2],
+                a.v[3] < b.v[3] ? a.v[3] : b.v[3]);
+}
+inline Float4 max(Float4 a, Float4 b) {
+  return Float4(a.v[0] > b.v[0] ? a.v[0] : b.v[0],
+                a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+                a.v[2] > b.v[2] ? a.v[2] : b.v[2],
+                a.v[3] > b.v[3] ? a.v[3] : b.v[3]);
+}
+
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {
+  return Float4(mask.v[0] ? a.v[0] : b.v[0], mask.v[1] ? a.v[1] : b.v[1],
+                mask.v[2] ? a.v[2] : b.v[2], mask.v[3] ? a.v[3] : b.v[3]);
+}
+
+#endif
+
+// Eight floats processed in lockstep. Without AVX the lanes are split into
+// two Float4 halves.
+struct alignas(32) Float8 {
+  Float8() = default;
+  Float8(float value);
+
+  // p has to be 32 byte aligned
+  static Float8 load(const float *p);
+  void store(float *p) const;
+
+#ifdef RAYTRACER_AVX
+  explicit Float8(__m256 v) : v(v) {}
+  __m256 v;
+#else
+  Float8(Float4 lo, Float4 hi) : lo(lo), hi(hi) {}
+  Float4 lo, hi;
+#endif
+};
+
+struct alignas(32) Mask8 {
+  // bit i is set if lane i is
+  int bits() const;
+  bool any() const { return bits() != 0; }
+
+#ifdef RAYTRACER_AVX
+  explicit Mask8(__m256 v) : v(v) {}
+  __m256 v;
+#else
+  Mask8(Mask4 lo, Mask4 hi) : lo(lo), hi(hi) {}
+  Mask4 lo, hi;
+#endif
+};
+
+#ifdef RAYTRACER_AVX
+
+inline Float8::Float8(float value) : v(_mm256_set1_ps(value)) {}
+inline Float8 Float8::load(const float *p) {
+  return Float8(_mm256_load_ps(p));
+}
+inline void Float8::store(float *p) const { _mm256_store_ps(p, v); }
+
+inline int Mask8::bits() const { return _mm256_movemask_ps(v); }
+
+inline Float8 operator+(Float8 a, Float8 b) {
+  return Float8(_mm256_add_ps(a.v, b.v));
+}
+inline Float8 operator-(Float8 a, Float8 b) {
+  return Float8(_mm256_sub_ps(a.v, b.v));
+}
+inline Float8 operator*(Float8 a, Float8 b) {
+  return Float8(_mm256_mul_ps(a.v, b.v));
+}
+inline Float8 operator/(Float8 a, Float8 b) {
+  return Float8(_mm256_div_ps(a.v, b.v));
+}
+inline Float8 operator-(Float8 a) {
+  return Float8(_mm256_sub_ps(_mm256_setzero_ps(), a.v));
+}
+inline Float8 sqrt(Float8 a) { return Float8(_mm256_sqrt_ps(a.v)); }
+
+inline Mask8 operator<(Float8 a, Float8 b) {
+  return Mask8(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ));
+}
+inline Mask8 operator>(Float8 a, Float8 b) {
+  return Mask8(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ));
+}
+inline Mask8 operator>=(Float8 a, Float8 b) {
+  return Mask8(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ));
+}
+inline Mask8 operator&&(Mask8 a, Mask8 b) {
+  return Mask8(_mm256_and_ps(a.v, b.v));
+}
+inline Mask8 operator||(Mask8 a, Mask8 b) {
+  return Mask8(_mm256_or_ps(a.v, b.v));
+}
+inline Mask8 operator!(Mask8 a) {
+  return Mask8(_mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+}
+
+inline Float8 select(Mask8 mask, Float8 a, Float8 b) {
+  return Float8(_mm256_blendv_ps(b.v, a.v, mask.v));
+}
+
+#else
+
+inline Float8::Float8(float value) : lo(value), hi(value) {}
+inline Float8 Float8::load(const float *p) {
+  return Float8(Float4::load(p), Float4::load(p + 4));
+}
+inline void Float8::store(float *p) const {
+  lo.store(p);
+  hi.store(p + 4);
+}
+
+inline int Mask8::bits() const {
+  int bits = 0;
+  for (int i = 0; i < 4; ++i) {
+    bits |= int(lo[i]) << i;
+    bits |= int(hi[i]) << (i + 4);
+  }
+  return bits;
+}
+
+#define RAYTRACER_FLOAT8_OP(op, result, type)                                 \
+  inline result operator op(type a, type b) {                                 \
+    return result(a.lo op b.lo, a.hi op b.hi);                                \
+  }
+
+RAYTRACER_FLOAT8_OP(+, Float8, Float8)
+RAYTRACER_FLOAT8_OP(-, Float8, Float8)
+RAYTRACER_FLOAT8_OP(*, Float8, Float8)
+RAYTRACER_FLOAT8_OP(/, Float8, Float8)
+RAYTRACER_FLOAT8_OP(<, Mask8, Float8)
+RAYTRACER_FLOAT8_OP(>, Mask8, Float8)
+RAYTRACER_FLOAT8_OP(>=, Mask8, Float8)
+RAYTRACER_FLOAT8_OP(&&, Mask8, Mask8)
+RAYTRACER_FLOAT8_OP(||, Mask8, Mask8)
+
+#undef RAYTRACER_FLOAT8_OP
+
+inline Float8 operator-(Float8 a) { return Float8(-a.lo, -a.hi); }
+inline Mask8 operator!(Mask8 a) { return Mask8(!a.lo, !a.hi); }
+inline Float8 sqrt(Float8 a) { return Float8(sqrt(a.lo), sqrt(a.hi)); }
+
+inline Float8 select(Mask8 mask, Float8 a, Float8 b) {
+  return Float8(select(mask.lo, a.lo, b.lo), select(mask.hi, a.hi, b.hi));
+}
+
+#endif
@@ -18,11 +18,28 @@ public:
     return s;
   }
 
-  std::vector<Intersection> intersept(const Ray &ray) const override;
+  void localIntersept(const Ray &ray, IntersectionBuffer &xs) const override;
+  void worldIntersept(const Ray &ray, IntersectionBuffer &xs) const override;
+
+  void localInterseptPacket(const RayPacket &rays,
+                            PacketHit &hits) const override;
+  void worldInterseptPacket(const RayPacket &rays,
+                            PacketHit &hits) const override;
+
+  bool interseptsBetween(const Ray &ray, float tMin,
+                         float tMax) const override;
+  bool worldInterseptsBetween(const Ray &ray, float tMin,
+                              float tMax) const override;
 
   vector_t localNormalsAt(const point_t &objectPoint) const override;
 
+  BoundingBox bounds() const override;
+
   bool operator==(const Shape &other) const override;
 
-private:
+  // world space center, the translation part of the transformation
+  point_t center() const;
+
+protected:
+  vector_t worldNormalsAt(const point_t &worldPoint) const override;
 };
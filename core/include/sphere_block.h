@@ -0,0 +1,58 @@
+#pragma once
+
+#include "matrix.h"
+#include "simd.h"
+#include <cstdint>
+
+class Ray;
+class Shape;
+
+// Up to eight spheres in structure of arrays layout: the inverse
+// transformation (or, for similarity transformations, the world space center
+// and radius) of every sphere is spread over the lanes, so one ray is tested
+// against all of them with eight wide SIMD operations instead of one virtual
+// Shape::intersept() call per sphere.
+class SphereBlock {
+public:
+  static constexpr uint32_t s_size = 8;
+
+  SphereBlock();
+
+  // sphere has to be a Sphere, its inverse transformation is copied
+  void add(const Shape *sphere);
+
+  uint32_t size() const { return size_; }
+  bool full() const { return size_ == s_size; }
+  const Shape *sphere(uint32_t i) const { return spheres_[i]; }
+
+  // lowers tMax to the nearest hit with 0 < t < tMax and sets object to the
+  // sphere hit; the hits are the same as Ray::closestHit() finds for the
+  // spheres one by one
+  void closestHit(const Ray &ray, float &tMax, const Shape *&object) const;
+
+  // true if a shadow casting sphere is hit for some t in (tMin, tMax)
+  bool interseptsBetween(const Ray &ray, float tMin, float tMax) const;
+
+private:
+  // roots of every lane, the mask holds the lanes with a non negative
+  // discriminant; unused lanes have to be masked out by the caller
+  Mask8 roots(const Ray &ray, Float8 &t1, Float8 &t2) const;
+  // roots from the world space centers and radii
+  Mask8 worldRoots(const Ray &ray, Float8 &t1, Float8 &t2) const;
+  // roots of the ray transformed into the object space of every lane
+  Mask8 objectRoots(const Ray &ray, Float8 &t1, Float8 &t2) const;
+
+  // rows 0-2 of every inverse transformation, m_[row * 4 + col][lane]
+  alignas(32) float m_[12][s_size];
+  // center and squared radius of spheres with a similarity transformation
+  alignas(32) float cx_[s_size];
+  alignas(32) float cy_[s_size];
+  alignas(32) float cz_[s_size];
+  alignas(32) float radiusSq_[s_size];
+  // 1 for lanes that use the world space form, 0 otherwise
+  alignas(32) float analytic_[s_size];
+  const Shape *spheres_[s_size];
+  uint32_t size_{0};
+  uint32_t analyticLanes_{0};
+  uint32_t castsShadows_{0};
+};
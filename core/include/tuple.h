@@ -1,13 +1,23 @@
 #pragma once
 
+#include "math.h"
 #include "matrix.h"
+#include "simd.h"
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
 
-struct Tuple {
+struct alignas(16) Tuple {
   Tuple() = default;
   Tuple(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
 
-  bool isVector() const;
-  bool isPoint() const;
+#ifdef RAYTRACER_SSE
+  explicit Tuple(__m128 v) { _mm_store_ps(&x, v); }
+  __m128 simd() const { return _mm_load_ps(&x); }
+#endif
+
+  bool isVector() const { return w == 0; }
+  bool isPoint() const { return w == 1; }
 
   float magnitude() const;
   Tuple normalize() const;
@@ -31,16 +41,117 @@ struct Tuple {
 using point_t = Tuple;
 using vector_t = Tuple;
 
-Tuple Vector(float x, float y, float z);
-Tuple Point(float x, float y, float z);
+inline Tuple Vector(float x, float y, float z) { return Tuple(x, y, z, 0); }
+inline Tuple Point(float x, float y, float z) { return Tuple(x, y, z, 1); }
+
+inline bool operator==(const Tuple &lhs, const Tuple &rhs) {
+  return epsilonEqual(lhs.x, rhs.x) && epsilonEqual(lhs.y, rhs.y) &&
+         epsilonEqual(lhs.z, rhs.z) && epsilonEqual(lhs.w, rhs.w);
+}
+
+inline Tuple operator+(const Tuple &lhs, const Tuple &rhs) {
+#ifdef RAYTRACER_SSE
+  return Tuple(_mm_add_ps(lhs.simd(), rhs.simd()));
+#else
+  return Tuple{lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w};
+#endif
+}
+
+inline Tuple operator-(const Tuple &lhs, const Tuple &rhs) {
+#ifdef RAYTRACER_SSE
+  return Tuple(_mm_sub_ps(lhs.simd(), rhs.simd()));
+#else
+  return Tuple{lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w};
+#endif
+}
+
+inline Tuple operator*(const Tuple &lhs, const float &rhs) {
+#ifdef RAYTRACER_SSE
+  return Tuple(_mm_mul_ps(lhs.simd(), _mm_set1_ps(rhs)));
+#else
+  return Tuple{lhs.x * rhs, lhs.y * rhs, lhs.z * rhs, lhs.w * rhs};
+#endif
+}
+
+inline Tuple operator*(const float &lhs, const Tuple &rhs) { return rhs * lhs; }
+
+inline Tuple operator/(const Tuple &lhs, const float &rhs) {
+#ifdef RAYTRACER_SSE
+  return Tuple(_mm_div_ps(lhs.simd(), _mm_set1_ps(rhs)));
+#else
+  return Tuple{lhs.x / rhs, lhs.y / rhs, lhs.z / rhs, lhs.w / rhs};
+#endif
+}
+
+inline Tuple operator-(const Tuple &value) {
+#ifdef RAYTRACER_SSE
+  return Tuple(_mm_sub_ps(_mm_setzero_ps(), value.simd()));
+#else
+  return Tuple{-value.x, -value.y, -value.z, -value.w};
+#endif
+}
+
+inline float dotProduct(const Tuple &lhs, const Tuple &rhs) {
+#ifdef RAYTRACER_SSE
+  const __m128 m = _mm_mul_ps(lhs.simd(), rhs.simd());
+  // (x + y, x + y, z + w, z + w), then fold the upper half onto the lower
+  __m128 shuffled = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1));
+  __m128 sums = _mm_add_ps(m, shuffled);
+  shuffled = _mm_movehl_ps(shuffled, sums);
+  return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+#else
+  return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+#endif
+}
+
+inline Tuple crossProduct(const Tuple &lhs, const Tuple &rhs) {
+#ifdef RAYTRACER_SSE
+  // a * b.yzx - a.yzx * b yields the cross product in zxy order
+  const __m128 a = lhs.simd();
+  const __m128 b = rhs.simd();
+  const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+  const __m128 xyz = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+  // clear w, which is only zero for finite inputs
+  return Tuple(_mm_and_ps(
+      xyz, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1))));
+#else
+  return Vector(lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z,
+                lhs.x * rhs.y - lhs.y * rhs.x);
+#endif
+}
+
+inline float Tuple::magnitude() const {
+  return std::sqrt(dotProduct(*this, *this));
+}
+
+inline Tuple Tuple::normalize() const { return *this / magnitude(); }
+
+inline Tuple Tuple::reflect(const Tuple &normal) const {
+  if (!isVector()) {
+    throw std::logic_error("Tuple::reflect() called on a non-vector object.");
+  }
+  if (!normal.isVector()) {
+    throw std::invalid_argument("Tuple::reflect() expects the 'normal' "
+                                "parameter to be a vector, but it is not.");
+  }
+  return (*this) - (normal * (2.f * dotProduct(*this, normal)));
+}
 
-bool operator==(const Tuple &lhs, const Tuple &rhs);
-Tuple operator+(const Tuple &lhs, const Tuple &rhs);
-Tuple operator-(const Tuple &lhs, const Tuple &rhs);
-Tuple operator*(const Tuple &lhs, const float &rhs);
-Tuple operator*(const float &lhs, const Tuple &rhs);
-Tuple operator/(const Tuple &lhs, const float &rhs);
-Tuple operator-(const Tuple &other);
+template <>
+inline Tuple Matrix<4, 4>::transformPoint(const Tuple &p) const {
+  assert(isAffine());
+  const auto &a = data_;
+  return Point(a[0][0] * p.x + a[0][1] * p.y + a[0][2] * p.z + a[0][3],
+               a[1][0] * p.x + a[1][1] * p.y + a[1][2] * p.z + a[1][3],
+               a[2][0] * p.x + a[2][1] * p.y + a[2][2] * p.z + a[2][3]);
+}
 
-float dotProduct(const Tuple &lhs, const Tuple &rhs);
-Tuple crossProduct(const Tuple &lhs, const Tuple &rhs);
+template <>
+inline Tuple Matrix<4, 4>::transformVector(const Tuple &v) const {
+  const auto &a = data_;
+  return Vector(a[0][0] * v.x + a[0][1] * v.y + a[0][2] * v.z,
+                a[1][0] * v.x + a[1][1] * v.y + a[1][2] * v.z,
+                a[2][0] * v.x + a[2][1] * v.y + a[2][2] * v.z);
+}
@@ -1,13 +1,16 @@
 #pragma once
 
+#include "bvh.h"
 #include "computation.h"
 #include "lightning.h"
+#include "medium_stack.h"
 #include "tuple.h"
 #include "types.h"
 #include <cstdint>
 #include <vector>
 
 class Ray;
+struct RayPacket;
 
 class World {
 public:
@@ -16,10 +19,16 @@ public:
 
   static World defaultWorld();
 
+  // the world owns its objects, intersections and computation data only
+  // point at them and must not outlive the object or its removal
   void addObject(const ShapePtr &object);
   void removeObject(const ShapePtr &object);
   const std::vector<ShapePtr> &objects() const { return objects_; }
-  std::vector<ShapePtr> &objects() { return objects_; }
+  // the caller may add or remove objects, so the hierarchy is rebuilt
+  std::vector<ShapePtr> &objects() {
+    bvhValid_ = false;
+    return objects_;
+  }
   bool containsObject(const ShapePtr &object) const;
 
   void addLight(const PointLight &light);
@@ -37,14 +46,41 @@ public:
   Color reflactedColor(const ComputationData &comps,
                        uint8_t recursionLimit = 4u) const;
 
-  Color colorAt(const Ray &r, uint8_t recursionLimit = 4u) const;
+  // media lists the objects the ray starts inside of, primary rays start
+  // outside of every object
+  Color colorAt(const Ray &r, uint8_t recursionLimit = 4u,
+                const MediumStack &media = {}) const;
 
+  // colorAt() for the four rays of a packet, only the first hits are found
+  // for the whole packet, shading continues with single rays
+  void colorAt(const RayPacket &rays, Color (&colors)[4],
+               uint8_t recursionLimit = 4u) const;
+
+  // whether light is blocked on the way from point to the light's position
+  bool isShadowed(point_t point, const PointLight &light) const;
+  // shadow test against the first light of the world
   bool isShadowed(point_t point) const;
 
+  // union of the world space bounds of all bounded objects
+  BoundingBox bounds() const;
+
+  // acceleration structure over objects(), built on first use and rebuilt
+  // once an object is moved or its castShadows() changes
+  const BVH &bvh() const;
+
+  // fills all lazily computed caches (e.g. inverse transformations) and
+  // brings the hierarchy up to date so the world can be read concurrently by
+  // several render threads; an unchanged world is not rebuilt
+  void prepare() const;
+
   void clear();
   bool isEmpty() const;
 
 private:
   std::vector<ShapePtr> objects_;
   std::vector<PointLight> lights_;
+  mutable BVH bvh_;
+  mutable bool bvhValid_{false};
+  // Shape::latestGeneration() when the hierarchy was last checked
+  mutable uint64_t bvhGeneration_{0};
 };
@@ -0,0 +1,189 @@
+#include "bvh.h"
+#include "shape.h"
+#include "sphere.h"
+#include <algorithm>
+#include <array>
+#include <typeinfo>
+
+namespace {
+constexpr size_t s_binCount = 16;
+constexpr size_t s_maxLeafSize = SphereBlock::s_size;
+constexpr float s_traversalCost = 1.f;
+// cost of testing a SphereBlock relative to a single primitive
+constexpr float s_blockCost = 2.f;
+
+float axisValue(const point_t &p, int axis) {
+  return axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+}
+
+size_t binIndex(const point_t &centroid, int axis, float lo, float scale) {
+  const auto bin =
+      static_cast<size_t>((axisValue(centroid, axis) - lo) * scale);
+  return std::min(bin, s_binCount - 1);
+}
+
+// only plain spheres go into blocks, subclasses may intersect differently
+bool isSphere(const Shape &shape) { return typeid(shape) == typeid(Sphere); }
+
+// spheres share one block test once there are at least two of them
+float leafCost(size_t spheres, size_t others) {
+  return (spheres >= 2 ? s_blockCost : float(spheres)) + float(others);
+}
+} // namespace
+
+struct BVH::BuildItem {
+  BoundingBox box;
+  point_t centroid;
+  ShapePtr shape;
+};
+
+void BVH::clear() {
+  nodes_.clear();
+  primitives_.clear();
+  unbounded_.clear();
+  blocks_.clear();
+}
+
+void BVH::build(const std::vector<ShapePtr> &objects) {
+  clear();
+
+  std::vector<BuildItem> items;
+  items.reserve(objects.size());
+  for (const auto &object : objects) {
+    const auto &box = object->worldBounds();
+    if (box.isInfinite()) {
+      unbounded_.push_back(object);
+    } else if (!box.isEmpty()) {
+      // pad the box so rounding in the slab test cannot miss grazing hits
+      const auto pad = Vector(epsilon, epsilon, epsilon);
+      items.push_back({BoundingBox(box.min - pad, box.max + pad),
+                       box.centroid(), object});
+    }
+  }
+  if (items.empty()) {
+    return;
+  }
+
+  nodes_.reserve(2 * items.size());
+  primitives_.reserve(items.size());
+  buildNode(items, 0, items.size(), 0);
+}
+
+uint32_t BVH::buildNode(std::vector<BuildItem> &items, size_t begin,
+                        size_t end, uint32_t depth) {
+  const uint32_t index = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back({});
+
+  BoundingBox box, centroids;
+  for (size_t i = begin; i < end; ++i) {
+    box.extend(items[i].box);
+    centroids.extend(items[i].centroid);
+  }
+  nodes_[index].box = box;
+
+  const size_t count = end - begin;
+  const size_t spheres = std::count_if(
+      items.begin() + begin, items.begin() + end,
+      [](const BuildItem &item) { return isSphere(*item.shape); });
+  auto makeLeaf = [&] {
+    // spheres first, the leading ones are also packed into a block
+    std::stable_partition(
+        items.begin() + begin, items.begin() + end,
+        [](const BuildItem &item) { return isSphere(*item.shape); });
+    nodes_[index].offset = static_cast<uint32_t>(primitives_.size());
+    nodes_[index].count = static_cast<uint32_t>(count);
+    nodes_[index].block = s_noBlock;
+    if (spheres >= 2) {
+      nodes_[index].block = static_cast<uint32_t>(blocks_.size());
+      SphereBlock &block = blocks_.emplace_back();
+      for (size_t i = begin; i < end && !block.full(); ++i) {
+        if (isSphere(*items[i].shape)) {
+          block.add(items[i].shape.get());
+        }
+      }
+    }
+    for (size_t i = begin; i < end; ++i) {
+      primitives_.push_back(items[i].shape);
+    }
+    return index;
+  };
+
+  if (count == 1 || depth >= s_maxDepth) {
+    return makeLeaf();
+  }
+
+  // binned SAH: evaluate s_binCount - 1 candidate planes along every axis
+  float bestCost = std::numeric_limits<float>::infinity();
+  int bestAxis = -1;
+  size_t bestSplit = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    const float lo = axisValue(centroids.min, axis);
+    const float extent = centroids.extent(axis);
+    if (extent <= 0.f) {
+      continue;
+    }
+    const float scale = s_binCount / extent;
+
+    std::array<BoundingBox, s_binCount> bins{};
+    std::array<size_t, s_binCount> binCounts{};
+    for (size_t i = begin; i < end; ++i) {
+      const size_t bin = binIndex(items[i].centroid, axis, lo, scale);
+      bins[bin].extend(items[i].box);
+      binCounts[bin]++;
+    }
+
+    // sweep from the right to get the area and count of every right side
+    std::array<float, s_binCount> rightArea{};
+    std::array<size_t, s_binCount> rightCount{};
+    BoundingBox right;
+    size_t rightN = 0;
+    for (size_t b = s_binCount - 1; b > 0; --b) {
+      right.extend(bins[b]);
+      rightN += binCounts[b];
+      rightArea[b] = right.surfaceArea();
+      rightCount[b] = rightN;
+    }
+
+    BoundingBox left;
+    size_t leftN = 0;
+    for (size_t b = 0; b + 1 < s_binCount; ++b) {
+      left.extend(bins[b]);
+      leftN += binCounts[b];
+      if (leftN == 0 || rightCount[b + 1] == 0) {
+        continue;
+      }
+      const float cost = left.surfaceArea() * leftN +
+                         rightArea[b + 1] * rightCount[b + 1];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestSplit = b + 1;
+      }
+    }
+  }
+
+  // all centroids coincide, no plane separates them
+  if (bestAxis < 0) {
+    return makeLeaf();
+  }
+  const float splitCost = s_traversalCost + bestCost / box.surfaceArea();
+  if (count <= s_maxLeafSize &&
+      splitCost >= leafCost(spheres, count - spheres)) {
+    return makeLeaf();
+  }
+
+  const float lo = axisValue(centroids.min, bestAxis);
+  const float scale = s_binCount / centroids.extent(bestAxis);
+  const auto it = std::partition(
+      items.begin() + begin, items.begin() + end, [&](const BuildItem &item) {
+        return binIndex(item.centroid, bestAxis, lo, scale) < bestSplit;
+      });
+  const size_t middle = static_cast<size_t>(it - items.begin());
+
+  nodes_[index].axis = static_cast<uint8_t>(bestAxis);
+  nodes_[index].count = 0;
+  nodes_[index].block = s_noBlock;
+  buildNode(items, begin, middle, depth + 1);
+  nodes_[index].offset = buildNode(items, middle, end, depth + 1);
+  return index;
+}
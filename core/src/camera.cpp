@@ -1,13 +1,23 @@
 #include "camera.h"
+#include "checkpoint.h"
+#include "parallel.h"
 #include "ray.h"
+#include "ray_packet.h"
+#include "row_sink.h"
 #include "tuple.h"
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 Camera::Camera(uint32_t hSize, uint32_t vSize, float fieldofView)
     : hSize_(hSize), vSize_(vSize), fieldOfView_(fieldofView) {
-  const float halfView = std::tanf(fieldofView / 2);
+  const float halfView = std::tan(fieldofView / 2);
   const float aspect = (float)hSize / vSize;
   if (aspect > 1.f) {
     halfWidth_ = halfView;
@@ -19,39 +29,271 @@ Camera::Camera(uint32_t hSize, uint32_t vSize, float fieldofView)
   pixelSize_ = (halfWidth_ * 2) / hSize;
 }
 
-Ray Camera::rayForPixel(uint32_t x, uint32_t y) const {
-  // the offset from the edge of the canvas to the pixel's center
-  const float xoffset = (float(x) + 0.5f) * pixelSize_;
-  const float yoffset = (float(y) + 0.5f) * pixelSize_;
+void Camera::refresh() const {
+  if (!dirty_) {
+    return;
+  }
+  const Mat44 inverse = transform_.inverse();
+
+  // the center of pixel (0, 0) on the canvas at z=-1, +x is to the *left*
+  // since the camera looks toward -z
+  const float cornerX = halfWidth_ - 0.5f * pixelSize_;
+  const float cornerY = halfHeight_ - 0.5f * pixelSize_;
 
-  // the untransformed coordinates of the pixel in world space.
-  // (remember that the camera looks toward -z, so +x is to the *left*.)
-  const float worldX = halfWidth_ - xoffset;
-  const float worldY = halfHeight_ - yoffset;
+  origin_ = inverse.transformPoint(Point(0, 0, 0));
+  toCorner_ = inverse.transformPoint(Point(cornerX, cornerY, -1)) - origin_;
+  stepX_ = inverse.transformVector(Vector(-pixelSize_, 0, 0));
+  stepY_ = inverse.transformVector(Vector(0, -pixelSize_, 0));
+  dirty_ = false;
+}
 
-  //  using the camera matrix, transform the canvas point and the origin,
-  // and then compute the ray's direction vector.
-  // (remember that th e canvas is at z=-1)
-  auto pixel = transform().inverse() * Point(worldX, worldY, -1);
-  pixel.w = 1;
-  auto origin = transform().inverse() * Point(0, 0, 0);
-  origin.w = 1;
+Ray Camera::rayForPixel(uint32_t x, uint32_t y) const {
+  refresh();
+  // the canvas is flat, so the pixel centers are evenly spaced in world space
+  const auto direction = (toCorner_ + stepX_ * float(x)) + stepY_ * float(y);
+  return Ray(origin_, direction.normalize());
+}
 
-  const auto direction = (pixel - origin).normalize();
+void Camera::directions(Float4 x, Float4 y, Float4 &dx, Float4 &dy,
+                        Float4 &dz) const {
+  // rayForPixel() with the same operation order, Tuple::normalize() divides
+  // by sqrt((x * x + y * y) + z * z)
+  dx = (Float4(toCorner_.x) + Float4(stepX_.x) * x) + Float4(stepY_.x) * y;
+  dy = (Float4(toCorner_.y) + Float4(stepX_.y) * x) + Float4(stepY_.y) * y;
+  dz = (Float4(toCorner_.z) + Float4(stepX_.z) * x) + Float4(stepY_.z) * y;
+  const Float4 length = sqrt((dx * dx + dy * dy) + dz * dz);
+  dx = dx / length;
+  dy = dy / length;
+  dz = dz / length;
+}
+
+void Camera::raysForTile(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1,
+                         std::vector<Ray> &rays) const {
+  refresh();
+  rays.clear();
+  rays.reserve(size_t(x1 - x0) * (y1 - y0));
+  for (uint32_t y = y0; y < y1; ++y) {
+    const Float4 fy(static_cast<float>(y));
+    for (uint32_t x = x0; x < x1; x += 4) {
+      Float4 dx, dy, dz;
+      directions(Float4(float(x), float(x + 1), float(x + 2), float(x + 3)),
+                 fy, dx, dy, dz);
+      for (uint32_t i = 0; i < 4 && x + i < x1; ++i) {
+        rays.emplace_back(origin_, Vector(dx[i], dy[i], dz[i]));
+      }
+    }
+  }
+}
 
-  return Ray(origin, direction);
+RayPacket Camera::packetForPixels(const uint32_t (&xs)[4],
+                                  const uint32_t (&ys)[4]) const {
+  refresh();
+  Float4 dx, dy, dz;
+  directions(Float4(float(xs[0]), float(xs[1]), float(xs[2]), float(xs[3])),
+             Float4(float(ys[0]), float(ys[1]), float(ys[2]), float(ys[3])),
+             dx, dy, dz);
+  return RayPacket(Float4(origin_.x), Float4(origin_.y), Float4(origin_.z),
+                   dx, dy, dz);
 }
 
 Canvas Camera::render(const World &world) const {
   Canvas image(hSize_, vSize_);
   // Canvas image(vSize_, hSize_);
+  world.prepare();
 
+  std::vector<Ray> rays;
   for (uint32_t y = 0; y < vSize_; ++y) {
+    raysForTile(0, y, hSize_, y + 1, rays);
     for (uint32_t x = 0; x < hSize_; ++x) {
-      const auto ray = rayForPixel(x, y);
-      const auto color = world.colorAt(ray);
+      const auto color = world.colorAt(rays[x]);
       image.writePixel(x, y, color);
     }
   }
   return image;
 }
+
+void Camera::renderTile(const World &world, bool packets, uint32_t x0,
+                        uint32_t y0, uint32_t x1, uint32_t y1, Color *pixels,
+                        size_t stride) const {
+  const auto pixel = [&](uint32_t x, uint32_t y) -> Color & {
+    return pixels[(y - y0) * stride + (x - x0)];
+  };
+  if (!packets) {
+    std::vector<Ray> rays;
+    raysForTile(x0, y0, x1, y1, rays);
+    auto ray = rays.begin();
+    for (uint32_t y = y0; y < y1; ++y) {
+      for (uint32_t x = x0; x < x1; ++x) {
+        pixel(x, y) = world.colorAt(*ray++);
+      }
+    }
+    return;
+  }
+  // 2x2 blocks, blocks cut by the tile border repeat their last pixel
+  for (uint32_t y = y0; y < y1; y += 2) {
+    for (uint32_t x = x0; x < x1; x += 2) {
+      const uint32_t xs[4] = {x, std::min(x + 1, x1 - 1), x,
+                              std::min(x + 1, x1 - 1)};
+      const uint32_t ys[4] = {y, y, std::min(y + 1, y1 - 1),
+                              std::min(y + 1, y1 - 1)};
+      Color colors[4];
+      world.colorAt(packetForPixels(xs, ys), colors);
+      for (int i = 0; i < 4; ++i) {
+        pixel(xs[i], ys[i]) = colors[i];
+      }
+    }
+  }
+}
+
+Canvas Camera::render(const World &world,
+                      const RenderOptions &options) const {
+  Canvas image(hSize_, vSize_, options.format);
+  render(world, options, image);
+  return image;
+}
+
+void Camera::render(const World &world, const RenderOptions &options,
+                    Canvas &image) const {
+  if (image.width() != hSize_ || image.height() != vSize_) {
+    throw std::invalid_argument("Camera: canvas size does not match");
+  }
+  world.prepare();
+  refresh();
+
+  const uint32_t tileSize = std::max(options.tileSize, 1u);
+  const uint32_t tilesX = (hSize_ + tileSize - 1) / tileSize;
+  const uint32_t tilesY = (vSize_ + tileSize - 1) / tileSize;
+
+  // every pixel belongs to exactly one tile, so workers never write the same
+  // canvas location and no synchronization is needed
+  parallelFor(size_t(tilesX) * tilesY, options.threads, [&](size_t tile) {
+    renderTile(world, options.packets, tile, tileSize, image);
+  });
+}
+
+void Camera::render(const World &world, const RenderOptions &options,
+                    Checkpoint &checkpoint) const {
+  Canvas &image = checkpoint.image();
+  if (image.width() != hSize_ || image.height() != vSize_) {
+    throw std::invalid_argument("Camera: checkpoint size does not match");
+  }
+  world.prepare();
+  refresh();
+
+  // tiles are traced the same way as without a checkpoint, so the resumed
+  // image is the one an uninterrupted render produces
+  const auto tiles = checkpoint.remaining();
+  parallelFor(tiles.size(), options.threads, [&](size_t i) {
+    renderTile(world, options.packets, tiles[i], checkpoint.tileSize(), image);
+    checkpoint.finish(tiles[i]);
+  });
+  checkpoint.save();
+}
+
+void Camera::renderTile(const World &world, bool packets, size_t tile,
+                        uint32_t tileSize, Canvas &image) const {
+  const uint32_t tilesX = (hSize_ + tileSize - 1) / tileSize;
+  const uint32_t x0 = uint32_t(tile % tilesX) * tileSize;
+  const uint32_t y0 = uint32_t(tile / tilesX) * tileSize;
+  const uint32_t x1 = std::min(x0 + tileSize, hSize_);
+  const uint32_t y1 = std::min(y0 + tileSize, vSize_);
+  // traced in full precision, converted to the canvas format row by row
+  std::vector<Color> pixels(size_t(x1 - x0) * (y1 - y0));
+  renderTile(world, packets, x0, y0, x1, y1, pixels.data(), x1 - x0);
+  for (uint32_t y = y0; y < y1; ++y) {
+    image.writePixels(
+        x0, y,
+        std::span<const Color>(pixels.data() + size_t(y - y0) * (x1 - x0),
+                               x1 - x0));
+  }
+}
+
+void Camera::render(const World &world, const RenderOptions &options,
+                    RowSink &sink) const {
+  world.prepare();
+  refresh();
+
+  const uint32_t tileSize = std::max(options.tileSize, 1u);
+  const uint32_t tilesX = (hSize_ + tileSize - 1) / tileSize;
+  const uint32_t bands = (vSize_ + tileSize - 1) / tileSize;
+  const size_t tiles = size_t(tilesX) * bands;
+  const uint32_t window = std::clamp(options.window, 1u, std::max(bands, 1u));
+  const size_t bandPixels = size_t(hSize_) * tileSize;
+
+  // band b is traced into slot b % window, which is free again once band
+  // b - window has been written
+  std::vector<Color> slots(bandPixels * window);
+  std::vector<size_t> pending(window, tilesX);
+
+  std::mutex mutex;
+  std::condition_variable written;
+  size_t nextTile = 0;
+  uint32_t nextBand = 0;
+  bool writing = false;
+  bool failed = false;
+
+  sink.begin(hSize_, vSize_);
+
+  // tiles are handed out in order, so the bands complete roughly top to
+  // bottom; parallelFor() only provides the workers
+  const uint32_t threads = std::clamp<uint32_t>(
+      options.threads, 1u, static_cast<uint32_t>(std::max<size_t>(tiles, 1)));
+  parallelFor(threads, threads, [&](size_t) {
+    try {
+      while (true) {
+        size_t tile;
+        uint32_t band;
+        {
+          std::unique_lock lock(mutex);
+          if (failed || nextTile == tiles) {
+            return;
+          }
+          tile = nextTile++;
+          band = uint32_t(tile / tilesX);
+          written.wait(lock,
+                       [&] { return failed || band < nextBand + window; });
+          if (failed) {
+            return;
+          }
+        }
+
+        const uint32_t x0 = uint32_t(tile % tilesX) * tileSize;
+        const uint32_t y0 = band * tileSize;
+        renderTile(world, options.packets, x0, y0,
+                   std::min(x0 + tileSize, hSize_),
+                   std::min(y0 + tileSize, vSize_),
+                   &slots[(band % window) * bandPixels + x0], hSize_);
+
+        std::unique_lock lock(mutex);
+        if (--pending[band % window] != 0 || writing) {
+          continue;
+        }
+        // one worker at a time passes the finished bands to the sink, in
+        // order and without holding the lock, so the others keep tracing
+        writing = true;
+        while (!failed && nextBand < bands &&
+               pending[nextBand % window] == 0) {
+          const uint32_t done = nextBand;
+          const uint32_t y = done * tileSize;
+          lock.unlock();
+          sink.writeRows(y, std::min(tileSize, vSize_ - y),
+                         &slots[(done % window) * bandPixels]);
+          lock.lock();
+          pending[done % window] = tilesX;
+          ++nextBand;
+          written.notify_all();
+        }
+        writing = false;
+      }
+    } catch (...) {
+      {
+        std::lock_guard lock(mutex);
+        failed = true;
+      }
+      written.notify_all();
+      throw;
+    }
+  });
+
+  sink.end();
+}
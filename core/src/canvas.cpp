@@ -1,25 +1,45 @@
 #include "canvas.h"
+#include "fd_io.h"
+#include "png_sink.h"
+#include "qoi_sink.h"
+#include "row_sink.h"
 #include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cerrno>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <utility>
+#include <vector>
 
-Canvas::Canvas(uint32_t width, uint32_t height)
-    : width_(width), height_(height) {
-  pixels_ = new Color[width * height];
+Canvas::Canvas(uint32_t width, uint32_t height, PixelFormat format)
+    : width_(width), height_(height), format_(format) {
+  // zero bytes are black in every format
+  pixels_ = new uint8_t[size_t(width) * height * bytesPerPixel(format)]();
 }
 
 Canvas::Canvas(Canvas &&other)
-    : width_(std::exchange(other.width_, 0)),
-      height_(std::exchange(other.height_, 0)),
-      pixels_(std::exchange(other.pixels_, nullptr)) {}
+    : pixels_(std::exchange(other.pixels_, nullptr)),
+      width_(std::exchange(other.width_, 0)),
+      height_(std::exchange(other.height_, 0)), format_(other.format_),
+      bottomUp_(other.bottomUp_),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mappingSize_(std::exchange(other.mappingSize_, 0)) {}
 
 Color Canvas::operator()(size_t w, size_t h) const {
-  return pixels_[w + (h * width_)];
+  Color color;
+  decodePixels(format_, pixels_ + offset(w, h, 1), 1, &color);
+  return color;
 }
 
 uint32_t Canvas::width() const { return width_; }
@@ -27,14 +47,29 @@ uint32_t Canvas::width() const { return width_; }
 uint32_t Canvas::height() const { return height_; }
 
 void Canvas::writePixel(size_t w, size_t h, Color color) {
-  if (w >= width_ || h >= height_) {
+  encodePixels(format_, &color, 1, pixels_ + offset(w, h, 1));
+}
+
+void Canvas::writePixels(size_t w, size_t h, std::span<const Color> colors) {
+  encodePixels(format_, colors.data(), colors.size(),
+               pixels_ + offset(w, h, colors.size()));
+}
+
+void Canvas::readPixels(size_t w, size_t h, std::span<Color> colors) const {
+  decodePixels(format_, pixels_ + offset(w, h, colors.size()), colors.size(),
+               colors.data());
+}
+
+size_t Canvas::offset(size_t w, size_t h, size_t count) const {
+  if (h >= height_ || w >= width_ || count > width_ - w) {
     throw std::out_of_range("Canvas out of range access");
   }
-  pixels_[w + h * width_] = color;
+  return size_t(row(h) - pixels_) + w * bytesPerPixel(format_);
 }
 
-std::span<Color> Canvas::pixels() const {
-  return std::span<Color>(pixels_, pixels_ + width_ * height_);
+uint8_t *Canvas::row(size_t h) const {
+  const size_t index = bottomUp_ ? height_ - 1 - h : h;
+  return pixels_ + index * width_ * bytesPerPixel(format_);
 }
 
 std::string Canvas::getAsPPM() const {
@@ -44,6 +79,322 @@ std::string Canvas::getAsPPM() const {
   return oss.str();
 }
 
+void Canvas::write(RowSink &sink) const {
+  sink.begin(width_, height_);
+  if (format_ == PixelFormat::SRGB8 && !bottomUp_) {
+    sink.writeQuantizedRows(0, height_, pixels_);
+  } else {
+    // about 64 KiB of decoded rows at a time
+    const size_t rowsPerChunk =
+        std::max<size_t>(1, (4 << 10) / std::max<size_t>(width_, 1));
+    std::vector<Color> rows(rowsPerChunk * width_);
+    for (uint32_t y = 0; y < height_; y += rowsPerChunk) {
+      const uint32_t count =
+          uint32_t(std::min<size_t>(rowsPerChunk, height_ - y));
+      for (uint32_t r = 0; r < count; ++r) {
+        decodePixels(format_, row(y + r), width_, &rows[size_t(r) * width_]);
+      }
+      sink.writeRows(y, count, rows.data());
+    }
+  }
+  sink.end();
+}
+
+void Canvas::writePPM(int fd) const {
+  PPMSink sink(fd);
+  write(sink);
+}
+
+namespace {
+// opens path for writing, runs write(fd) and closes it again
+template <typename Write>
+void writeFile(const std::string &path, const Write &write) {
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Canvas: cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+  try {
+    write(fd);
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  if (::close(fd) != 0) {
+    throw std::runtime_error("Canvas: cannot close " + path + ": " +
+                             std::strerror(errno));
+  }
+}
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+} // namespace
+
+void Canvas::savePPM(const std::string &path) const {
+  writeFile(path, [this](int fd) { writePPM(fd); });
+}
+
+void Canvas::save(const std::string &path) const {
+  if (endsWith(path, ".ppm")) {
+    savePPM(path);
+  } else if (endsWith(path, ".qoi")) {
+    writeFile(path, [this](int fd) {
+      QOISink sink(fd);
+      write(sink);
+    });
+  } else if (endsWith(path, ".pfm")) {
+    writeFile(path, [this](int fd) { writePFM(fd); });
+  } else if (endsWith(path, ".png")) {
+    writeFile(path, [this](int fd) {
+      PNGSink sink(fd);
+      write(sink);
+    });
+  } else {
+    throw std::invalid_argument("Canvas: unknown image format of " + path);
+  }
+}
+
+namespace {
+// next whitespace separated word of a header, the whitespace after it is
+// consumed as well
+std::string readToken(int fd) {
+  std::string token;
+  char c;
+  while (true) {
+    readAll(fd, &c, 1);
+    if (!std::isspace(static_cast<unsigned char>(c))) {
+      token += c;
+    } else if (!token.empty()) {
+      return token;
+    }
+    if (token.size() > 32) {
+      throw std::runtime_error("Canvas: malformed PFM header");
+    }
+  }
+}
+
+uint32_t readDimension(int fd) {
+  const std::string token = readToken(fd);
+  if (token.empty() ||
+      token.find_first_not_of("0123456789") != std::string::npos ||
+      token.size() > 9) {
+    throw std::runtime_error("Canvas: malformed PFM size " + token);
+  }
+  return uint32_t(std::stoul(token));
+}
+
+// a negative scale marks little endian data, the rows are written in the
+// native byte order; the scale is padded with zeros until the pixels start
+// at a multiple of alignment
+std::string pfmHeader(uint32_t width, uint32_t height, size_t alignment = 1) {
+  const bool little = std::endian::native == std::endian::little;
+  std::string header = "PF\n" + std::to_string(width) + " " +
+                       std::to_string(height) + "\n" +
+                       (little ? "-1.0" : "1.0");
+  while ((header.size() + 1) % alignment != 0) {
+    header += '0';
+  }
+  return header + "\n";
+}
+
+void byteSwap(float *values, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, &values[i], sizeof(bits));
+    bits = (bits >> 24) | ((bits >> 8) & 0xff00u) | ((bits << 8) & 0xff0000u) |
+           (bits << 24);
+    std::memcpy(&values[i], &bits, sizeof(bits));
+  }
+}
+} // namespace
+
+void Canvas::writePFM(int fd) const {
+  const std::string header = pfmHeader(width_, height_);
+  writeAll(fd, header.data(), header.size());
+
+  const size_t rowBytes = size_t(width_) * 12;
+  std::vector<Color> colors;
+  std::vector<float> floats;
+  for (uint32_t y = height_; y-- > 0;) {
+    if (format_ == PixelFormat::RGB32F) {
+      writeAll(fd, row(y), rowBytes);
+      continue;
+    }
+    colors.resize(width_);
+    floats.resize(size_t(width_) * 3);
+    decodePixels(format_, row(y), width_, colors.data());
+    encodePixels(PixelFormat::RGB32F, colors.data(), width_,
+                 reinterpret_cast<uint8_t *>(floats.data()));
+    writeAll(fd, floats.data(), rowBytes);
+  }
+}
+
+Canvas Canvas::readPFM(int fd) {
+  const std::string type = readToken(fd);
+  if (type != "PF" && type != "Pf") {
+    throw std::runtime_error("Canvas: not a PFM file");
+  }
+  const uint32_t width = readDimension(fd);
+  const uint32_t height = readDimension(fd);
+  float scale;
+  try {
+    scale = std::stof(readToken(fd));
+  } catch (const std::logic_error &) {
+    throw std::runtime_error("Canvas: malformed PFM scale");
+  }
+  if (scale == 0.f || !std::isfinite(scale)) {
+    throw std::runtime_error("Canvas: malformed PFM scale");
+  }
+  const bool little = std::endian::native == std::endian::little;
+  const bool swap = (scale < 0.f) != little;
+  const uint32_t channels = type == "PF" ? 3 : 1;
+
+  // the size is checked against the data before anything is allocated, so a
+  // malformed header cannot ask for gigabytes
+  if (height != 0 && width > SIZE_MAX / 12 / height) {
+    throw std::runtime_error("Canvas: PFM size too large");
+  }
+  const size_t dataBytes = size_t(width) * height * channels * sizeof(float);
+  struct stat info;
+  if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+    const off_t offset = ::lseek(fd, 0, SEEK_CUR);
+    if (offset < 0 || info.st_size < offset ||
+        size_t(info.st_size - offset) < dataBytes) {
+      throw std::runtime_error("Canvas: PFM data is truncated");
+    }
+  }
+  Canvas canvas = [&] {
+    try {
+      return Canvas(width, height, PixelFormat::RGB32F);
+    } catch (const std::bad_alloc &) {
+      throw std::runtime_error("Canvas: PFM size too large");
+    }
+  }();
+  std::vector<float> gray(channels == 1 ? width : 0);
+  for (uint32_t y = height; y-- > 0;) {
+    auto *row =
+        reinterpret_cast<float *>(canvas.pixels_ + size_t(y) * width * 12);
+    float *values = channels == 3 ? row : gray.data();
+    readAll(fd, values, size_t(width) * channels * sizeof(float));
+    if (swap) {
+      byteSwap(values, size_t(width) * channels);
+    }
+    if (channels == 1) {
+      for (uint32_t x = 0; x < width; ++x) {
+        row[x * 3] = row[x * 3 + 1] = row[x * 3 + 2] = gray[x];
+      }
+    }
+  }
+  return canvas;
+}
+
+Canvas Canvas::loadPFM(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Canvas: cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+  try {
+    Canvas canvas = readPFM(fd);
+    ::close(fd);
+    return canvas;
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+}
+
+Canvas Canvas::createMappedPFM(const std::string &path, uint32_t width,
+                               uint32_t height) {
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Canvas: cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+  try {
+    // aligned so the mapped rows can be loaded like any other pixels
+    const std::string header = pfmHeader(width, height, 16);
+    writeAll(fd, header.data(), header.size());
+    // the file is extended without writing the pixels, the OS supplies
+    // zero pages for them
+    const size_t size = header.size() + size_t(width) * height * 12;
+    if (::ftruncate(fd, off_t(size)) != 0) {
+      throw std::runtime_error("Canvas: cannot resize " + path + ": " +
+                               std::strerror(errno));
+    }
+    Canvas canvas = map(fd, width, height, header.size());
+    ::close(fd);
+    return canvas;
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+}
+
+Canvas Canvas::openMappedPFM(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    throw std::runtime_error("Canvas: cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+  try {
+    if (readToken(fd) != "PF") {
+      throw std::runtime_error("Canvas: " + path + " is no color PFM");
+    }
+    const uint32_t width = readDimension(fd);
+    const uint32_t height = readDimension(fd);
+    const std::string scale = readToken(fd);
+    const bool little = std::endian::native == std::endian::little;
+    if (scale.empty() || (scale[0] == '-') != little) {
+      throw std::runtime_error("Canvas: " + path +
+                               " is not in the native byte order");
+    }
+    const off_t headerSize = ::lseek(fd, 0, SEEK_CUR);
+    struct stat info;
+    if (headerSize < 0 || ::fstat(fd, &info) != 0 ||
+        size_t(info.st_size) <
+            size_t(headerSize) + size_t(width) * height * 12) {
+      throw std::runtime_error("Canvas: " + path + " is truncated");
+    }
+    Canvas canvas = map(fd, width, height, size_t(headerSize));
+    ::close(fd);
+    return canvas;
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+}
+
+Canvas Canvas::map(int fd, uint32_t width, uint32_t height,
+                   size_t headerSize) {
+  const size_t size = headerSize + size_t(width) * height * 12;
+  void *mapping =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error(std::string("Canvas: mmap failed: ") +
+                             std::strerror(errno));
+  }
+  // the mapping stays valid after fd is closed
+  Canvas canvas(0, 0, PixelFormat::RGB32F);
+  delete[] canvas.pixels_;
+  canvas.mapping_ = static_cast<uint8_t *>(mapping);
+  canvas.mappingSize_ = size;
+  canvas.pixels_ = canvas.mapping_ + headerSize;
+  canvas.width_ = width;
+  canvas.height_ = height;
+  canvas.bottomUp_ = true;
+  return canvas;
+}
+
+void Canvas::sync() const {
+  if (mapping_ && ::msync(mapping_, mappingSize_, MS_SYNC) != 0) {
+    throw std::runtime_error(std::string("Canvas: msync failed: ") +
+                             std::strerror(errno));
+  }
+}
+
 void Canvas::writePPMHeader(std::ostringstream &oss) const {
   oss << "P3" << std::endl
       << width_ << " " << height_ << std::endl
@@ -66,7 +417,7 @@ void Canvas::writePPMPixelsRow(std::ostringstream &oss, size_t row) const {
 
 uint32_t Canvas::writePPMPixel(std::ostringstream &oss, size_t row, size_t col,
                                uint32_t rowWidth) const {
-  const Color c = pixels_[col + row * width_];
+  const Color c = (*this)(col, row);
   rowWidth = writePPMColorComponent(oss, c.r(), rowWidth);
   rowWidth = writePPMColorComponent(oss, c.g(), rowWidth);
   return rowWidth = writePPMColorComponent(oss, c.b(), rowWidth);
@@ -96,7 +447,9 @@ uint32_t Canvas::writePPMColorComponent(std::ostringstream &oss, float value,
 }
 
 Canvas::~Canvas() {
-  if (pixels_) {
+  if (mapping_) {
+    ::munmap(mapping_, mappingSize_);
+  } else if (pixels_) {
     delete[] pixels_;
   }
 }
@@ -0,0 +1,154 @@
+#include "checkpoint.h"
+#include "fd_io.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+std::string bitmapPath(const std::string &path) { return path + ".tiles"; }
+
+Canvas openImage(const std::string &path, uint32_t width, uint32_t height,
+                 bool resume) {
+  if (resume) {
+    auto image = Canvas::openMappedPFM(path);
+    if (image.width() != width || image.height() != height) {
+      throw std::runtime_error("Checkpoint: " + path +
+                               " has another image size");
+    }
+    return image;
+  }
+  // a stale bitmap must not outlive the image it was written for
+  std::remove(bitmapPath(path).c_str());
+  return Canvas::createMappedPFM(path, width, height);
+}
+
+[[noreturn]] void fail(const std::string &what, const std::string &path) {
+  throw std::runtime_error("Checkpoint: cannot " + what + " " + path + ": " +
+                           std::strerror(errno));
+}
+} // namespace
+
+Checkpoint::Checkpoint(const std::string &path, uint32_t width,
+                       uint32_t height, uint32_t tileSize, bool resume,
+                       std::chrono::milliseconds interval)
+    : path_(path), tileSize_(std::max(tileSize, 1u)),
+      image_(openImage(path, width, height, resume)), interval_(interval),
+      lastSave_(std::chrono::steady_clock::now()) {
+  const size_t tilesX = (size_t(width) + tileSize_ - 1) / tileSize_;
+  const size_t tilesY = (size_t(height) + tileSize_ - 1) / tileSize_;
+  finished_.assign(tilesX * tilesY, 0);
+  if (resume) {
+    read();
+  } else {
+    write(finished_);
+  }
+}
+
+std::vector<size_t> Checkpoint::remaining() const {
+  std::vector<size_t> tiles;
+  for (size_t tile = 0; tile < finished_.size(); ++tile) {
+    if (!finished_[tile]) {
+      tiles.push_back(tile);
+    }
+  }
+  return tiles;
+}
+
+void Checkpoint::finish(size_t tile) {
+  std::vector<uint8_t> finished;
+  {
+    std::lock_guard lock(mutex_);
+    finished_[tile] = 1;
+    const auto now = std::chrono::steady_clock::now();
+    if (saving_ || now - lastSave_ < interval_) {
+      return;
+    }
+    // one worker saves, the others keep rendering meanwhile
+    saving_ = true;
+    lastSave_ = now;
+    finished = finished_;
+  }
+  try {
+    image_.sync();
+    write(finished);
+  } catch (...) {
+    std::lock_guard lock(mutex_);
+    saving_ = false;
+    throw;
+  }
+  std::lock_guard lock(mutex_);
+  saving_ = false;
+}
+
+void Checkpoint::save() {
+  std::vector<uint8_t> finished;
+  {
+    std::lock_guard lock(mutex_);
+    lastSave_ = std::chrono::steady_clock::now();
+    finished = finished_;
+  }
+  image_.sync();
+  write(finished);
+}
+
+std::string Checkpoint::header() const {
+  return "tiles " + std::to_string(image_.width()) + " " +
+         std::to_string(image_.height()) + " " + std::to_string(tileSize_) +
+         "\n";
+}
+
+void Checkpoint::write(const std::vector<uint8_t> &finished) const {
+  std::string content = header();
+  std::string bits((finished.size() + 7) / 8, '\0');
+  for (size_t tile = 0; tile < finished.size(); ++tile) {
+    if (finished[tile]) {
+      bits[tile / 8] = char(uint8_t(bits[tile / 8]) | (1u << (tile % 8)));
+    }
+  }
+  content += bits;
+
+  // written next to the bitmap and renamed over it, so a kill while saving
+  // leaves the previous bitmap intact
+  const std::string path = bitmapPath(path_);
+  const std::string temporary = path + ".tmp";
+  const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    fail("open", temporary);
+  }
+  try {
+    writeAll(fd, content.data(), content.size());
+    if (::fsync(fd) != 0) {
+      fail("sync", temporary);
+    }
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  if (::close(fd) != 0) {
+    fail("close", temporary);
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    fail("rename", temporary);
+  }
+}
+
+void Checkpoint::read() {
+  const std::string path = bitmapPath(path_);
+  const std::string content = readFile(path);
+
+  const std::string expected = header();
+  if (content.compare(0, expected.size(), expected) != 0 ||
+      content.size() != expected.size() + (finished_.size() + 7) / 8) {
+    throw std::runtime_error("Checkpoint: " + path +
+                             " was written for another render");
+  }
+  const auto *bits =
+      reinterpret_cast<const uint8_t *>(content.data() + expected.size());
+  for (size_t tile = 0; tile < finished_.size(); ++tile) {
+    finished_[tile] = (bits[tile / 8] >> (tile % 8)) & 1;
+  }
+}
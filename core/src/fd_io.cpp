@@ -0,0 +1,67 @@
+#include "fd_io.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void writeAll(int fd, const void *data, size_t size) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    const ssize_t written = ::write(fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("write failed: ") +
+                               std::strerror(errno));
+    }
+    bytes += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+
+void readAll(int fd, void *data, size_t size) {
+  auto *bytes = static_cast<uint8_t *>(data);
+  while (size > 0) {
+    const ssize_t count = ::read(fd, bytes, size);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("read failed: ") +
+                               std::strerror(errno));
+    }
+    if (count == 0) {
+      throw std::runtime_error("read failed: unexpected end of file");
+    }
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+}
+
+std::string readFile(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+  std::string content;
+  try {
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      throw std::runtime_error("cannot stat " + path + ": " +
+                               std::strerror(errno));
+    }
+    content.resize(size_t(info.st_size));
+    readAll(fd, content.data(), content.size());
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  return content;
+}
@@ -1,6 +1,6 @@
 #include "intersection.h"
 
-std::optional<const Intersection> hit(const std::vector<Intersection> &xs) {
+std::optional<const Intersection> hit(const IntersectionBuffer &xs) {
   auto it = std::find_if(xs.begin(), xs.end(),
                          [](const Intersection &i) { return i.t() > 0; });
   if (it != xs.end())
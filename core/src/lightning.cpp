@@ -13,7 +13,7 @@ bool PointLight::operator==(const PointLight &other) const {
   return position_ == other.position() && intensity_ == other.intensity();
 }
 
-Color lightining(const Material &material, const ShapeConstPtr &shape,
+Color lightining(const Material &material, const Shape *shape,
                  const PointLight &light, const point_t &position,
                  const vector_t &eyeVec, const vector_t &normalVec,
                  bool inShadow) {
@@ -26,7 +26,7 @@ Color lightining(const Material &material, const ShapeConstPtr &shape,
 
   // compute the ambient contribution
   const auto ambient = Color(effectiveColor * material.ambient());
-  if (inShadow || !shape->castShadows()) {
+  if (inShadow) {
     return ambient;
   }
 
@@ -52,7 +52,7 @@ Color lightining(const Material &material, const ShapeConstPtr &shape,
       specular = Color::black();
     } else {
       // compute the specular contribution
-      const auto factor = std::powf(reflectDotEye, material.shiness());
+      const auto factor = std::pow(reflectDotEye, material.shiness());
       specular = light.intensity() * material.specular() * factor;
     }
   }
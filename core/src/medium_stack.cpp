@@ -0,0 +1,35 @@
+#include "medium_stack.h"
+#include "shape.h"
+#include <algorithm>
+
+bool MediumStack::contains(const Shape *object) const {
+  return std::find(objects_.begin(), objects_.end(), object) != objects_.end();
+}
+
+float MediumStack::refractiveIndex() const {
+  return objects_.empty() ? 1.f
+                          : objects_.back()->material().reflectiveIndex();
+}
+
+float MediumStack::refractiveIndexAfter(const Shape *object) const {
+  if (!contains(object)) {
+    return object->material().reflectiveIndex();
+  }
+  // leaving object, the innermost of the remaining media takes over
+  for (auto it = objects_.end(); it != objects_.begin();) {
+    --it;
+    if (*it != object) {
+      return (*it)->material().reflectiveIndex();
+    }
+  }
+  return 1.f;
+}
+
+void MediumStack::cross(const Shape *object) {
+  const auto it = std::find(objects_.begin(), objects_.end(), object);
+  if (it != objects_.end()) {
+    objects_.erase(it);
+  } else {
+    objects_.push_back(object);
+  }
+}
@@ -0,0 +1,115 @@
+#include "parallel.h"
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+class WorkRange {
+public:
+  void assign(size_t begin, size_t end) {
+    std::lock_guard lock(mutex_);
+    begin_ = begin;
+    end_ = end;
+  }
+
+  bool pop(size_t &index) {
+    std::lock_guard lock(mutex_);
+    if (begin_ == end_)
+      return false;
+    index = begin_++;
+    return true;
+  }
+
+  size_t remaining() {
+    std::lock_guard lock(mutex_);
+    return end_ - begin_;
+  }
+
+  // hands out the upper half of the remaining indices
+  bool steal(size_t &begin, size_t &end) {
+    std::lock_guard lock(mutex_);
+    const size_t count = end_ - begin_;
+    if (count == 0)
+      return false;
+    const size_t stolen = (count + 1) / 2;
+    end = end_;
+    begin = end_ -= stolen;
+    return true;
+  }
+
+private:
+  std::mutex mutex_;
+  size_t begin_{0};
+  size_t end_{0};
+};
+
+} // namespace
+
+void parallelFor(size_t count, uint32_t threads,
+                 const std::function<void(size_t)> &task) {
+  threads = std::clamp<uint32_t>(
+      threads, 1u, static_cast<uint32_t>(std::max<size_t>(count, 1)));
+  if (threads == 1) {
+    for (size_t i = 0; i < count; ++i)
+      task(i);
+    return;
+  }
+
+  std::vector<WorkRange> ranges(threads);
+  for (uint32_t t = 0; t < threads; ++t) {
+    ranges[t].assign(count * t / threads, count * (t + 1) / threads);
+  }
+
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto worker = [&](uint32_t id) {
+    WorkRange &own = ranges[id];
+    while (true) {
+      size_t index;
+      while (own.pop(index)) {
+        try {
+          task(index);
+        } catch (...) {
+          std::lock_guard lock(errorMutex);
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+
+      // own range is drained - steal from the busiest other worker
+      WorkRange *victim = nullptr;
+      size_t most = 0;
+      for (uint32_t t = 0; t < threads; ++t) {
+        if (t == id)
+          continue;
+        const size_t remaining = ranges[t].remaining();
+        if (remaining > most) {
+          most = remaining;
+          victim = &ranges[t];
+        }
+      }
+      if (!victim)
+        return;
+      size_t begin, end;
+      if (victim->steal(begin, end))
+        own.assign(begin, end);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (uint32_t t = 1; t < threads; ++t) {
+    workers.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
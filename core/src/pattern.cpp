@@ -5,10 +5,12 @@
 #include <cmath>
 #include <memory>
 
-Color Pattern::colorAtObject(const ShapeConstPtr &shape,
+Color Pattern::colorAtObject(const Shape *shape,
                              const point_t &worldPoint) const {
-  const point_t objectPoint = shape->transformation().inverse() * worldPoint;
-  const point_t patternPoint = transformation().inverse() * objectPoint;
+  const point_t objectPoint =
+      shape->inverseTransformation().transformPoint(worldPoint);
+  const point_t patternPoint =
+      inverseTransformation().transformPoint(objectPoint);
   return colorAt(patternPoint);
 }
 
@@ -130,7 +132,8 @@ Color PerlinNoisePattern::colorAt(const point_t &point) const {
   const float distortion = PerlinNoise::noise(point.x, point.y, point.z);
   const auto disturbedPoint =
       Point(point.x + distortion, point.y + distortion, point.z + distortion);
-  return pattern_->colorAt(pattern_->transformation() * disturbedPoint);
+  return pattern_->colorAt(
+      pattern_->transformation().transformPoint(disturbedPoint));
 }
 
 bool PerlinNoisePattern::operator==(const PatternPtr &other) const {
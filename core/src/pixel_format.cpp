@@ -0,0 +1,163 @@
+#include "pixel_format.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void quantize(const Color *pixels, size_t count, uint8_t *bytes) {
+  // round() is rounding half away from zero, which for the clamped, non
+  // negative values is the truncated value plus one if the dropped fraction
+  // is at least 0.5
+  size_t i = 0;
+#ifdef RAYTRACER_SSE
+  const __m128 scale = _mm_set1_ps(255.f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 half = _mm_set1_ps(.5f);
+  const auto channels = [&](const Color &c) {
+    // max() returns its second operand for NaN, so NaN turns into 0
+    const __m128 v =
+        _mm_min_ps(_mm_max_ps(_mm_mul_ps(c.simd(), scale), zero), scale);
+    const __m128i truncated = _mm_cvttps_epi32(v);
+    const __m128 fraction = _mm_sub_ps(v, _mm_cvtepi32_ps(truncated));
+    // the comparison yields -1 for lanes that round up
+    return _mm_sub_epi32(truncated,
+                         _mm_castps_si128(_mm_cmpge_ps(fraction, half)));
+  };
+  alignas(16) uint8_t packed[16];
+  for (; i + 4 <= count; i += 4) {
+    const __m128i rg = _mm_packs_epi32(channels(pixels[i]),
+                                       channels(pixels[i + 1]));
+    const __m128i ba = _mm_packs_epi32(channels(pixels[i + 2]),
+                                       channels(pixels[i + 3]));
+    _mm_store_si128(reinterpret_cast<__m128i *>(packed),
+                    _mm_packus_epi16(rg, ba));
+    // drop the fourth lane of every pixel
+    for (int p = 0; p < 4; ++p) {
+      std::memcpy(bytes + (i + p) * 3, packed + p * 4, 3);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    const float channels[3] = {pixels[i].r(), pixels[i].g(), pixels[i].b()};
+    for (int c = 0; c < 3; ++c) {
+      float v = channels[c] * 255.f;
+      v = std::isnan(v) ? 0.f : std::clamp(v, 0.f, 255.f);
+      const int truncated = static_cast<int>(v);
+      bytes[i * 3 + c] = static_cast<uint8_t>(
+          truncated + (v - static_cast<float>(truncated) >= .5f ? 1 : 0));
+    }
+  }
+}
+
+uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = uint16_t((bits >> 16) & 0x8000u);
+  const uint32_t magnitude = bits & 0x7fffffffu;
+
+  if (magnitude >= 0x7f800000u) {
+    // infinity keeps its sign, NaN stays a quiet NaN
+    return sign | (magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u);
+  }
+  if (magnitude >= 0x477ff000u) {
+    // rounds to a value above the largest half, 65504
+    return sign | 0x7c00u;
+  }
+  if (magnitude < 0x38800000u) {
+    // half subnormal or zero: the value in units of 2^-24, rounded to even
+    if (magnitude < 0x33000000u) {
+      return sign;
+    }
+    const uint32_t exponent = magnitude >> 23;
+    const uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+    const uint32_t shift = 126 - exponent;
+    const uint32_t half = mantissa >> shift;
+    const uint32_t rest = mantissa & ((1u << shift) - 1);
+    const uint32_t midpoint = 1u << (shift - 1);
+    const bool up = rest > midpoint || (rest == midpoint && (half & 1u));
+    return sign | uint16_t(half + (up ? 1u : 0u));
+  }
+  // normal: rebias the exponent and round the mantissa to 10 bits, a carry
+  // into the exponent is the correct result
+  const uint32_t rebiased = magnitude - 0x38000000u;
+  const uint32_t rest = rebiased & 0x1fffu;
+  uint32_t half = rebiased >> 13;
+  if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+    ++half;
+  }
+  return sign | uint16_t(half);
+}
+
+float halfToFloat(uint16_t half) {
+  const uint32_t sign = uint32_t(half & 0x8000u) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1fu;
+  uint32_t mantissa = half & 0x3ffu;
+  uint32_t bits;
+  if (exponent == 0x1fu) {
+    bits = sign | 0x7f800000u | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else if (mantissa == 0) {
+    bits = sign;
+  } else {
+    // subnormal half, normalize it for the float exponent
+    uint32_t e = 113;
+    while ((mantissa & 0x400u) == 0) {
+      mantissa <<= 1;
+      --e;
+    }
+    bits = sign | (e << 23) | ((mantissa & 0x3ffu) << 13);
+  }
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void encodePixels(PixelFormat format, const Color *colors, size_t count,
+                  uint8_t *bytes) {
+  switch (format) {
+  case PixelFormat::RGB32F:
+    for (size_t i = 0; i < count; ++i) {
+      const float rgb[3] = {colors[i].r(), colors[i].g(), colors[i].b()};
+      std::memcpy(bytes + i * 12, rgb, 12);
+    }
+    return;
+  case PixelFormat::RGB16F:
+    for (size_t i = 0; i < count; ++i) {
+      const uint16_t rgb[3] = {floatToHalf(colors[i].r()),
+                               floatToHalf(colors[i].g()),
+                               floatToHalf(colors[i].b())};
+      std::memcpy(bytes + i * 6, rgb, 6);
+    }
+    return;
+  case PixelFormat::SRGB8:
+    quantize(colors, count, bytes);
+    return;
+  }
+}
+
+void decodePixels(PixelFormat format, const uint8_t *bytes, size_t count,
+                  Color *colors) {
+  switch (format) {
+  case PixelFormat::RGB32F:
+    for (size_t i = 0; i < count; ++i) {
+      float rgb[3];
+      std::memcpy(rgb, bytes + i * 12, 12);
+      colors[i] = Color(rgb[0], rgb[1], rgb[2]);
+    }
+    return;
+  case PixelFormat::RGB16F:
+    for (size_t i = 0; i < count; ++i) {
+      uint16_t rgb[3];
+      std::memcpy(rgb, bytes + i * 6, 6);
+      colors[i] = Color(halfToFloat(rgb[0]), halfToFloat(rgb[1]),
+                        halfToFloat(rgb[2]));
+    }
+    return;
+  case PixelFormat::SRGB8:
+    for (size_t i = 0; i < count; ++i) {
+      const uint8_t *rgb = bytes + i * 3;
+      colors[i] = Color(rgb[0] / 255.f, rgb[1] / 255.f, rgb[2] / 255.f);
+    }
+    return;
+  }
+}
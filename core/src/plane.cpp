@@ -1,22 +1,44 @@
 #include "plane.h"
 #include "intersection.h"
+#include "ray_packet.h"
 #include "tuple.h"
 #include <cmath>
 #include <cstdlib>
-#include <vector>
+#include <limits>
 
-std::vector<Intersection> Plane::intersept(const Ray &ray) const {
+void Plane::localIntersept(const Ray &ray, IntersectionBuffer &xs) const {
   if (std::abs(ray.direction().y) < epsilon) {
-    return {};
+    return;
   }
   const float t = -ray.origin().y / ray.direction().y;
-  return {Intersection{t, shared_from_this()}};
+  xs.emplace_back(t, this);
+}
+
+void Plane::localInterseptPacket(const RayPacket &rays,
+                                 PacketHit &hits) const {
+  const Mask4 crossing = abs(rays.dy) >= Float4(epsilon);
+  const Float4 t = -rays.oy / rays.dy;
+  hits.update(crossing && t > Float4(0.f) && t < Float4::load(hits.t), t,
+              this);
+}
+
+bool Plane::interseptsBetween(const Ray &ray, float tMin, float tMax) const {
+  if (std::abs(ray.direction().y) < epsilon) {
+    return false;
+  }
+  const float t = -ray.origin().y / ray.direction().y;
+  return t > tMin && t < tMax;
 }
 
 vector_t Plane::localNormalsAt(const point_t &objectPoint) const {
   return Vector(0, 1, 0);
 };
 
+BoundingBox Plane::bounds() const {
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  return BoundingBox(Point(-inf, 0, -inf), Point(inf, 0, inf));
+}
+
 bool Plane::operator==(const Shape &other) const {
   const Plane *s = dynamic_cast<const Plane *>(&other);
   return s && Shape::operator==(other);
@@ -0,0 +1,132 @@
+#include "png_sink.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+// largest payload of a stored deflate block
+constexpr size_t s_maxBlock = 65535;
+
+constexpr std::array<uint32_t, 256> crcTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t n = 0; n < 256; ++n) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    }
+    table[n] = c;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> s_crcTable = crcTable();
+
+uint32_t updateCrc(uint32_t crc, const uint8_t *data, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    crc = s_crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+uint32_t updateAdler(uint32_t adler, const uint8_t *data, size_t size) {
+  uint32_t a = adler & 0xffff;
+  uint32_t b = adler >> 16;
+  while (size > 0) {
+    // 5552 bytes is the most that cannot overflow b before the modulo
+    const size_t n = std::min<size_t>(size, 5552);
+    for (size_t i = 0; i < n; ++i) {
+      a += data[i];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+    data += n;
+    size -= n;
+  }
+  return b << 16 | a;
+}
+} // namespace
+
+void PNGSink::writeChunk(const char (&type)[5], const uint8_t *data,
+                         size_t size) {
+  std::vector<uint8_t> head;
+  appendBigEndian(head, uint32_t(size));
+  head.insert(head.end(), type, type + 4);
+  write(head.data(), head.size());
+  write(data, size);
+
+  uint32_t crc = updateCrc(0xffffffffu, head.data() + 4, 4);
+  crc = updateCrc(crc, data, size) ^ 0xffffffffu;
+  std::vector<uint8_t> tail;
+  appendBigEndian(tail, crc);
+  write(tail.data(), tail.size());
+}
+
+void PNGSink::writeHeader() {
+  static constexpr uint8_t signature[] = {0x89, 'P',  'N',  'G',
+                                          '\r', '\n', 0x1a, '\n'};
+  write(signature, sizeof(signature));
+
+  std::vector<uint8_t> header;
+  appendBigEndian(header, width());
+  appendBigEndian(header, height());
+  // 8 bit depth, truecolor, deflate, adaptive filtering, no interlace
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  writeChunk("IHDR", header.data(), header.size());
+
+  block_.clear();
+  block_.reserve(s_maxBlock);
+  adler_ = 1;
+  first_ = true;
+}
+
+void PNGSink::writeQuantizedRows(uint32_t, uint32_t count,
+                                 const uint8_t *rgb) {
+  const size_t rowBytes = size_t(width()) * 3;
+  for (uint32_t row = 0; row < count; ++row, rgb += rowBytes) {
+    // every scanline starts with its filter type, 0 is none
+    const uint8_t filter = 0;
+    const uint8_t *parts[] = {&filter, rgb};
+    const size_t sizes[] = {1, rowBytes};
+    for (int p = 0; p < 2; ++p) {
+      const uint8_t *data = parts[p];
+      size_t size = sizes[p];
+      while (size > 0) {
+        const size_t n = std::min(size, s_maxBlock - block_.size());
+        block_.insert(block_.end(), data, data + n);
+        data += n;
+        size -= n;
+        if (block_.size() == s_maxBlock) {
+          flushBlock(false);
+        }
+      }
+    }
+  }
+}
+
+void PNGSink::flushBlock(bool last) {
+  std::vector<uint8_t> chunk;
+  chunk.reserve(block_.size() + 11);
+  if (first_) {
+    // zlib header: deflate with a 32 KiB window, no dictionary
+    chunk.insert(chunk.end(), {0x78, 0x01});
+    first_ = false;
+  }
+  // stored block header, byte aligned: final flag, then LEN and ~LEN
+  const uint16_t size = uint16_t(block_.size());
+  chunk.insert(chunk.end(),
+               {uint8_t(last ? 1 : 0), uint8_t(size), uint8_t(size >> 8),
+                uint8_t(~size), uint8_t(~size >> 8)});
+  chunk.insert(chunk.end(), block_.begin(), block_.end());
+  adler_ = updateAdler(adler_, block_.data(), block_.size());
+  if (last) {
+    appendBigEndian(chunk, adler_);
+  }
+  writeChunk("IDAT", chunk.data(), chunk.size());
+  block_.clear();
+}
+
+void PNGSink::end() {
+  flushBlock(true);
+  writeChunk("IEND", nullptr, 0);
+}
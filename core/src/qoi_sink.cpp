@@ -0,0 +1,93 @@
+#include "qoi_sink.h"
+
+namespace {
+constexpr uint8_t s_opIndex = 0x00;
+constexpr uint8_t s_opDiff = 0x40;
+constexpr uint8_t s_opLuma = 0x80;
+constexpr uint8_t s_opRun = 0xc0;
+constexpr uint8_t s_opRgb = 0xfe;
+constexpr uint32_t s_maxRun = 62;
+constexpr size_t s_bufferSize = 64 << 10;
+} // namespace
+
+void QOISink::writeHeader() {
+  // a reused sink starts every image from the initial encoder state
+  previous_ = Pixel{0, 0, 0, 255};
+  for (auto &entry : index_) {
+    entry = Pixel{};
+  }
+  run_ = 0;
+  buffer_.clear();
+  buffer_.reserve(s_bufferSize);
+  buffer_.insert(buffer_.end(), {'q', 'o', 'i', 'f'});
+  appendBigEndian(buffer_, width());
+  appendBigEndian(buffer_, height());
+  // three channels, sRGB
+  buffer_.push_back(3);
+  buffer_.push_back(0);
+}
+
+void QOISink::reserve(size_t bytes) {
+  if (buffer_.size() + bytes > s_bufferSize) {
+    write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+}
+
+void QOISink::flushRun() {
+  if (run_ > 0) {
+    reserve(1);
+    buffer_.push_back(uint8_t(s_opRun | (run_ - 1)));
+    run_ = 0;
+  }
+}
+
+void QOISink::writeQuantizedRows(uint32_t, uint32_t count,
+                                 const uint8_t *rgb) {
+  const size_t pixels = size_t(width()) * count;
+  for (size_t i = 0; i < pixels; ++i, rgb += 3) {
+    const Pixel pixel{rgb[0], rgb[1], rgb[2], 255};
+    if (pixel == previous_) {
+      if (++run_ == s_maxRun) {
+        flushRun();
+      }
+      continue;
+    }
+    flushRun();
+    // the longest encoding, s_opRgb, takes four bytes
+    reserve(4);
+
+    const uint8_t hash = uint8_t(
+        (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64);
+    if (index_[hash] == pixel) {
+      buffer_.push_back(uint8_t(s_opIndex | hash));
+    } else {
+      index_[hash] = pixel;
+      // wrapping differences, as the decoder adds them modulo 256
+      const int dr = int8_t(pixel.r - previous_.r);
+      const int dg = int8_t(pixel.g - previous_.g);
+      const int db = int8_t(pixel.b - previous_.b);
+      const int drg = dr - dg;
+      const int dbg = db - dg;
+      if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+        buffer_.push_back(
+            uint8_t(s_opDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+      } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 &&
+                 dbg >= -8 && dbg <= 7) {
+        buffer_.push_back(uint8_t(s_opLuma | (dg + 32)));
+        buffer_.push_back(uint8_t((drg + 8) << 4 | (dbg + 8)));
+      } else {
+        buffer_.insert(buffer_.end(), {s_opRgb, pixel.r, pixel.g, pixel.b});
+      }
+    }
+    previous_ = pixel;
+  }
+}
+
+void QOISink::end() {
+  flushRun();
+  reserve(8);
+  buffer_.insert(buffer_.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+}
@@ -6,9 +6,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 #include <optional>
-#include <ranges>
-#include <vector>
 
 Ray::Ray(const point_t &origin, const vector_t &direction)
     : origin_(origin), direction_(direction) {
@@ -24,32 +23,83 @@ const vector_t &Ray::direction() const { return direction_; }
 
 point_t Ray::position(float t) const { return origin_ + direction_ * t; }
 
-std::vector<Intersection> Ray::intersept(const ShapePtr &shape) const {
-  const Ray r = (*this) * shape->transformation().inverse();
-  return shape->intersept(r);
+IntersectionBuffer Ray::intersept(const ShapePtr &shape) const {
+  IntersectionBuffer xs;
+  shape->worldIntersept(*this, xs);
+  return xs;
 }
 
-std::vector<Intersection> Ray::intersept(const World &world) const {
-  auto all = world.objects() | std::views::transform([this](const auto &obj) {
-               return intersept(obj);
-             }) |
-             std::views::join;
-
-  std::vector<Intersection> xs;
+IntersectionBuffer Ray::intersept(const World &world) const {
+  IntersectionBuffer xs;
 
-  std::ranges::copy(all, std::back_inserter(xs));
+  // the whole line is traversed, the refraction indices in precompute() also
+  // depend on the intersections behind the origin
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  world.bvh().traverse(origin_, direction_, -inf, inf,
+                       [&](const ShapePtr &shape, float &) {
+                         shape->worldIntersept(*this, xs);
+                       });
 
   std::sort(xs.begin(), xs.end());
   return xs;
 }
 
+std::optional<Intersection> Ray::closestHit(const World &world) const {
+  std::optional<Intersection> closest;
+  IntersectionBuffer xs;
+
+  const auto visit = [&](const ShapePtr &shape, float &tMax) {
+    xs.clear();
+    shape->worldIntersept(*this, xs);
+    for (const auto &i : xs) {
+      if (i.t() > 0.f && i.t() < tMax) {
+        tMax = i.t();
+        closest = i;
+      }
+    }
+  };
+  const auto visitBlock = [&](const SphereBlock &block, float &tMax) {
+    const Shape *object = nullptr;
+    block.closestHit(*this, tMax, object);
+    if (object) {
+      closest = Intersection(tMax, object);
+    }
+  };
+
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  world.bvh().traverse(origin_, direction_, 0.f, inf, visit, visitBlock);
+  return closest;
+}
+
+bool Ray::isOccluded(const World &world, float distance) const {
+  bool occluded = false;
+
+  const auto visit = [&](const ShapePtr &shape, float &tMax) {
+    if (!shape->castShadows()) {
+      return;
+    }
+    if (shape->worldInterseptsBetween(*this, 0.f, tMax)) {
+      occluded = true;
+      tMax = -std::numeric_limits<float>::infinity();
+    }
+  };
+  const auto visitBlock = [&](const SphereBlock &block, float &tMax) {
+    if (block.interseptsBetween(*this, 0.f, tMax)) {
+      occluded = true;
+      tMax = -std::numeric_limits<float>::infinity();
+    }
+  };
+
+  world.bvh().traverse(origin_, direction_, 0.f, distance, visit, visitBlock);
+  return occluded;
+}
+
 Ray Ray::operator*(const Mat44 &m) const {
-  return Ray{m * origin_, m * direction_};
+  return Ray{m.transformPoint(origin_), m.transformVector(direction_)};
 }
 
-ComputationData
-Ray::precompute(const Intersection &intersection,
-                std::optional<std::vector<Intersection>> xs) const {
+ComputationData Ray::precompute(const Intersection &intersection,
+                                const MediumStack &media) const {
   ComputationData data{};
 
   data.t = intersection.t();
@@ -68,27 +118,21 @@ Ray::precompute(const Intersection &intersection,
   data.underPoint = data.point - data.normalV * epsilon;
   data.reflectiveV = direction().reflect(data.normalV);
 
-  std::vector<ShapeConstPtr> containers;
-  for (const auto &curr : xs.value_or(std::vector<Intersection>{})) {
-    if (curr == intersection) {
-      data.n1 = (containers.empty())
-                    ? 1.f
-                    : containers.back()->material().reflectiveIndex();
-    }
+  data.media = media;
+  data.n1 = media.refractiveIndex();
+  data.n2 = media.refractiveIndexAfter(data.object);
 
-    auto it = std::find(containers.begin(), containers.end(), curr.object());
-    if (it != containers.end()) {
-      containers.erase(it);
-    } else {
-      containers.push_back(curr.object());
-    }
+  return data;
+}
 
+ComputationData Ray::precompute(const Intersection &intersection,
+                                const IntersectionBuffer &xs) const {
+  MediumStack media;
+  for (const auto &curr : xs) {
     if (curr == intersection) {
-      data.n2 = (containers.empty())
-                    ? 1.f
-                    : containers.back()->material().reflectiveIndex();
+      break;
     }
+    media.cross(curr.object());
   }
-
-  return data;
+  return precompute(intersection, media);
 }
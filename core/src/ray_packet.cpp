@@ -0,0 +1,55 @@
+#include "ray_packet.h"
+#include "shape.h"
+#include "world.h"
+
+void PacketHit::update(Mask4 mask, Float4 t, const Shape *object) {
+  if (!mask.any()) {
+    return;
+  }
+  select(mask, t, Float4::load(this->t)).store(this->t);
+  for (int i = 0; i < s_size; ++i) {
+    if (mask[i]) {
+      this->object[i] = object;
+    }
+  }
+}
+
+RayPacket::RayPacket(const Ray (&rays)[s_size])
+    : ox(rays[0].origin().x, rays[1].origin().x, rays[2].origin().x,
+         rays[3].origin().x),
+      oy(rays[0].origin().y, rays[1].origin().y, rays[2].origin().y,
+         rays[3].origin().y),
+      oz(rays[0].origin().z, rays[1].origin().z, rays[2].origin().z,
+         rays[3].origin().z),
+      dx(rays[0].direction().x, rays[1].direction().x, rays[2].direction().x,
+         rays[3].direction().x),
+      dy(rays[0].direction().y, rays[1].direction().y, rays[2].direction().y,
+         rays[3].direction().y),
+      dz(rays[0].direction().z, rays[1].direction().z, rays[2].direction().z,
+         rays[3].direction().z) {}
+
+RayPacket RayPacket::operator*(const Mat44 &m) const {
+  // same operation order as Mat44::transformPoint() / transformVector(), so
+  // every lane matches the transformed single ray exactly
+  return RayPacket(
+      Float4(m(0, 0)) * ox + Float4(m(0, 1)) * oy + Float4(m(0, 2)) * oz +
+          Float4(m(0, 3)),
+      Float4(m(1, 0)) * ox + Float4(m(1, 1)) * oy + Float4(m(1, 2)) * oz +
+          Float4(m(1, 3)),
+      Float4(m(2, 0)) * ox + Float4(m(2, 1)) * oy + Float4(m(2, 2)) * oz +
+          Float4(m(2, 3)),
+      Float4(m(0, 0)) * dx + Float4(m(0, 1)) * dy + Float4(m(0, 2)) * dz,
+      Float4(m(1, 0)) * dx + Float4(m(1, 1)) * dy + Float4(m(1, 2)) * dz,
+      Float4(m(2, 0)) * dx + Float4(m(2, 1)) * dy + Float4(m(2, 2)) * dz);
+}
+
+PacketHit RayPacket::closestHits(const World &world) const {
+  PacketHit hits;
+  const Float4 origin[3] = {ox, oy, oz};
+  const Float4 direction[3] = {dx, dy, dz};
+  world.bvh().traverse(origin, direction, hits.t,
+                       [&](const ShapePtr &shape) {
+                         shape->worldInterseptPacket(*this, hits);
+                       });
+  return hits;
+}
@@ -0,0 +1,59 @@
+#include "row_sink.h"
+#include "fd_io.h"
+#include "pixel_format.h"
+#include <algorithm>
+#include <string>
+
+void RowSink::writeQuantizedRows(uint32_t y, uint32_t count,
+                                 const uint8_t *rgb) {
+  // about 64 KiB of colors at a time
+  const size_t width = this->width();
+  const size_t rowsPerChunk =
+      std::max<size_t>(1, (4 << 10) / std::max<size_t>(width, 1));
+  std::vector<Color> colors(rowsPerChunk * width);
+  for (size_t row = 0; row < count; row += rowsPerChunk) {
+    const size_t rows = std::min<size_t>(rowsPerChunk, count - row);
+    decodePixels(PixelFormat::SRGB8, rgb + row * width * 3, rows * width,
+                 colors.data());
+    writeRows(uint32_t(y + row), uint32_t(rows), colors.data());
+  }
+}
+
+void EncoderSink::writeRows(uint32_t y, uint32_t count, const Color *pixels) {
+  const size_t width = this->width();
+  const size_t rowBytes = width * 3;
+  if (rowBytes == 0) {
+    return;
+  }
+  // about 64 KiB of quantized rows at a time
+  const size_t rowsPerChunk = std::max<size_t>(1, (64 << 10) / rowBytes);
+  buffer_.resize(rowsPerChunk * rowBytes);
+  for (size_t row = 0; row < count; row += rowsPerChunk) {
+    const size_t rows = std::min<size_t>(rowsPerChunk, count - row);
+    quantize(pixels + row * width, rows * width, buffer_.data());
+    writeQuantizedRows(uint32_t(y + row), uint32_t(rows), buffer_.data());
+  }
+}
+
+void EncoderSink::write(const uint8_t *data, size_t size) {
+  writeAll(fd_, data, size);
+}
+
+void EncoderSink::appendBigEndian(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back(uint8_t(value >> 24));
+  out.push_back(uint8_t(value >> 16));
+  out.push_back(uint8_t(value >> 8));
+  out.push_back(uint8_t(value));
+}
+
+void PPMSink::writeHeader() {
+  const std::string header = "P6\n" + std::to_string(width()) + " " +
+                             std::to_string(height()) + "\n255\n";
+  write(reinterpret_cast<const uint8_t *>(header.data()), header.size());
+}
+
+void PPMSink::writeQuantizedRows(uint32_t, uint32_t count,
+                                 const uint8_t *rgb) {
+  // already the bytes of the file
+  write(rgb, size_t(width()) * 3 * count);
+}
@@ -0,0 +1,330 @@
+#include "scene.h"
+#include "fd_io.h"
+#include "material.h"
+#include "pattern.h"
+#include "plane.h"
+#include "sphere.h"
+#include "transformations.h"
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+template <typename T> PatternPtr makePattern(PatternPtr a, PatternPtr b) {
+  return std::make_shared<T>(std::move(a), std::move(b));
+}
+
+constexpr std::array s_binaryPatterns{
+    std::pair{std::string_view("stripe"), &makePattern<StripePattern>},
+    std::pair{std::string_view("gradient"), &makePattern<GradientPattern>},
+    std::pair{std::string_view("ring"), &makePattern<RingPattern>},
+    std::pair{std::string_view("checker"), &makePattern<CheckerPattern>},
+    std::pair{std::string_view("radial-gradient"),
+              &makePattern<RadialGradientPattern>},
+    std::pair{std::string_view("blend"), &makePattern<BlendPattern>}};
+
+float radians(float degrees) { return degrees * float(M_PI) / 180.f; }
+
+// recursive descent over the words of the text; objects are built while
+// they are read, there is no intermediate syntax tree
+class Parser {
+public:
+  explicit Parser(std::string_view text) : text_(text) {}
+
+  Scene scene() {
+    World world;
+    std::optional<Camera> sceneCamera;
+    for (auto word = next(); !word.empty(); word = next()) {
+      if (word == "camera") {
+        sceneCamera.emplace(camera());
+      } else if (word == "light") {
+        world.addLight(light());
+      } else if (word == "sphere") {
+        world.addObject(shape(std::make_shared<Sphere>()));
+      } else if (word == "plane") {
+        world.addObject(shape(std::make_shared<Plane>()));
+      } else {
+        unexpected(word);
+      }
+    }
+    if (!sceneCamera) {
+      fail("the scene has no camera");
+    }
+    return Scene{std::move(world), std::move(*sceneCamera)};
+  }
+
+private:
+  // the next word, empty at the end of the text; braces are words on their
+  // own even without whitespace around them
+  std::string_view next() {
+    while (pos_ < text_.size()) {
+      const char c = text_[pos_];
+      if (c == '\n') {
+        ++line_;
+      } else if (c == '#') {
+        while (pos_ < text_.size() && text_[pos_] != '\n') {
+          ++pos_;
+        }
+        continue;
+      } else if (!std::isspace(static_cast<unsigned char>(c))) {
+        break;
+      }
+      ++pos_;
+    }
+    const size_t begin = pos_;
+    if (pos_ < text_.size() && (text_[pos_] == '{' || text_[pos_] == '}')) {
+      return text_.substr(pos_++, 1);
+    }
+    while (pos_ < text_.size() && text_[pos_] != '{' && text_[pos_] != '}' &&
+           text_[pos_] != '#' &&
+           !std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+    return text_.substr(begin, pos_ - begin);
+  }
+
+  [[noreturn]] void fail(const std::string &message) const {
+    throw std::runtime_error("scene line " + std::to_string(line_) + ": " +
+                             message);
+  }
+
+  [[noreturn]] void unexpected(std::string_view word) const {
+    fail(word.empty() ? "unexpected end of the scene"
+                      : "unexpected '" + std::string(word) + "'");
+  }
+
+  void expect(std::string_view expected) {
+    if (const auto word = next(); word != expected) {
+      unexpected(word);
+    }
+  }
+
+  float number() {
+    const auto word = next();
+    float value;
+    const auto [end, error] =
+        std::from_chars(word.data(), word.data() + word.size(), value);
+    if (word.empty() || error != std::errc() ||
+        end != word.data() + word.size() || !std::isfinite(value)) {
+      fail("expected a number instead of '" + std::string(word) + "'");
+    }
+    return value;
+  }
+
+  uint32_t size() {
+    const float value = number();
+    if (value < 1.f || value != std::floor(value) || value > 1e6f) {
+      fail("expected a size in pixels");
+    }
+    return uint32_t(value);
+  }
+
+  bool boolean() {
+    const auto word = next();
+    if (word != "true" && word != "false") {
+      fail("expected true or false instead of '" + std::string(word) + "'");
+    }
+    return word == "true";
+  }
+
+  Tuple triple() {
+    const float x = number();
+    const float y = number();
+    const float z = number();
+    return Tuple(x, y, z, 0.f);
+  }
+
+  Color color() { return Color(triple()); }
+  point_t point() {
+    const auto t = triple();
+    return Point(t.x, t.y, t.z);
+  }
+  vector_t vector() {
+    const auto t = triple();
+    return Vector(t.x, t.y, t.z);
+  }
+
+  Camera camera() {
+    expect("{");
+    uint32_t width = 0, height = 0;
+    float fov = 0.f;
+    point_t from = Point(0, 0, 0), to = Point(0, 0, -1);
+    vector_t up = Vector(0, 1, 0);
+    for (auto word = next(); word != "}"; word = next()) {
+      if (word == "width") {
+        width = size();
+      } else if (word == "height") {
+        height = size();
+      } else if (word == "fov") {
+        fov = number();
+      } else if (word == "from") {
+        from = point();
+      } else if (word == "to") {
+        to = point();
+      } else if (word == "up") {
+        up = vector();
+      } else {
+        unexpected(word);
+      }
+    }
+    if (width == 0 || height == 0 || !(fov > 0.f && fov < 180.f)) {
+      fail("the camera needs a width, a height and a fov in (0, 180)");
+    }
+    Camera camera(width, height, radians(fov));
+    camera.setTransorm(view(from, to, up));
+    return camera;
+  }
+
+  PointLight light() {
+    expect("{");
+    std::optional<point_t> position;
+    Color intensity(1.f, 1.f, 1.f);
+    for (auto word = next(); word != "}"; word = next()) {
+      if (word == "position") {
+        position = point();
+      } else if (word == "intensity") {
+        intensity = color();
+      } else {
+        unexpected(word);
+      }
+    }
+    if (!position) {
+      fail("the light has no position");
+    }
+    return PointLight(*position, intensity);
+  }
+
+  ShapePtr shape(ShapePtr shape) {
+    expect("{");
+    for (auto word = next(); word != "}"; word = next()) {
+      if (word == "transform") {
+        shape->setTransformation(transform());
+      } else if (word == "material") {
+        material(shape->material());
+      } else if (word == "shadow") {
+        shape->setCastsShadows(boolean());
+      } else {
+        unexpected(word);
+      }
+    }
+    return shape;
+  }
+
+  Mat44 transform() {
+    expect("{");
+    Mat44 m = Mat44::identity();
+    for (auto word = next(); word != "}"; word = next()) {
+      if (word == "translate") {
+        const auto t = triple();
+        m = m * translation(t.x, t.y, t.z);
+      } else if (word == "scale") {
+        const auto t = triple();
+        m = m * scaling(t.x, t.y, t.z);
+      } else if (word == "rotate-x") {
+        m = m * rotationX(radians(number()));
+      } else if (word == "rotate-y") {
+        m = m * rotationY(radians(number()));
+      } else if (word == "rotate-z") {
+        m = m * rotationZ(radians(number()));
+      } else if (word == "shear") {
+        float s[6];
+        for (auto &value : s) {
+          value = number();
+        }
+        m = m * shearing(s[0], s[1], s[2], s[3], s[4], s[5]);
+      } else {
+        unexpected(word);
+      }
+    }
+    if (m.determinant() == 0.f) {
+      fail("the transform is not invertible");
+    }
+    return m;
+  }
+
+  void material(Material &material) {
+    expect("{");
+    for (auto word = next(); word != "}"; word = next()) {
+      if (word == "color") {
+        material.setColor(color());
+      } else if (word == "pattern") {
+        material.setPattern(pattern());
+      } else if (word == "ambient") {
+        material.setAmbient(number());
+      } else if (word == "diffuse") {
+        material.setDiffuse(number());
+      } else if (word == "specular") {
+        material.setSpecular(number());
+      } else if (word == "shininess") {
+        material.setShiness(number());
+      } else if (word == "reflective") {
+        material.setReflective(number());
+      } else if (word == "transparency") {
+        material.setTransparency(number());
+      } else if (word == "refractive-index") {
+        material.setReflectiveIndex(number());
+      } else {
+        unexpected(word);
+      }
+    }
+  }
+
+  PatternPtr pattern() {
+    const auto kind = next();
+    if (!kind.empty() && (std::isdigit(static_cast<unsigned char>(kind[0])) ||
+                          kind[0] == '-' || kind[0] == '.')) {
+      // a solid color, the word just read is its red component
+      pos_ -= kind.size();
+      return std::make_shared<SolidPattern>(color());
+    }
+    const bool perlin = kind == "perlin";
+    PatternPtr (*make)(PatternPtr, PatternPtr) = nullptr;
+    for (const auto &[name, function] : s_binaryPatterns) {
+      if (kind == name) {
+        make = function;
+      }
+    }
+    if (!perlin && !make) {
+      fail("unknown pattern '" + std::string(kind) + "'");
+    }
+
+    expect("{");
+    PatternPtr a, b;
+    std::optional<Mat44> m;
+    for (auto word = next(); word != "}"; word = next()) {
+      if (word == (perlin ? "pattern" : "a")) {
+        a = pattern();
+      } else if (word == "b" && !perlin) {
+        b = pattern();
+      } else if (word == "transform") {
+        m = transform();
+      } else {
+        unexpected(word);
+      }
+    }
+    if (perlin ? !a : !a || !b) {
+      fail(perlin ? "perlin needs a pattern"
+                  : std::string(kind) + " needs the patterns a and b");
+    }
+    PatternPtr result = perlin ? std::make_shared<PerlinNoisePattern>(a)
+                               : make(a, b);
+    if (m) {
+      result->setTransformation(*m);
+    }
+    return result;
+  }
+
+  std::string_view text_;
+  size_t pos_{0};
+  uint32_t line_{1};
+};
+} // namespace
+
+Scene parseScene(std::string_view text) { return Parser(text).scene(); }
+
+Scene loadScene(const std::string &path) { return parseScene(readFile(path)); }
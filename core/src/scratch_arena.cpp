@@ -0,0 +1,45 @@
+#include "scratch_arena.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+ScratchArena &ScratchArena::local() {
+  thread_local ScratchArena arena;
+  return arena;
+}
+
+void *ScratchArena::allocate(size_t bytes, size_t alignment) {
+  for (; block_ < blocks_.size(); ++block_, offset_ = 0) {
+    Block &block = blocks_[block_];
+    const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+    const uintptr_t aligned =
+        (base + offset_ + alignment - 1) & ~uintptr_t(alignment - 1);
+    if (aligned + bytes <= base + block.size) {
+      offset_ = aligned + bytes - base;
+      ++outstanding_;
+      return reinterpret_cast<void *>(aligned);
+    }
+  }
+
+  // none of the existing blocks has room left
+  const size_t size = std::max(s_blockSize, bytes + alignment);
+  blocks_.push_back(Block{std::make_unique<std::byte[]>(size), size});
+  block_ = blocks_.size() - 1;
+  offset_ = 0;
+  return allocate(bytes, alignment);
+}
+
+void ScratchArena::release() {
+  assert(outstanding_ > 0);
+  if (--outstanding_ == 0) {
+    block_ = 0;
+    offset_ = 0;
+  }
+}
+
+size_t ScratchArena::reservedBytes() const {
+  size_t bytes = 0;
+  for (const auto &block : blocks_)
+    bytes += block.size;
+  return bytes;
+}
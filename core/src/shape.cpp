@@ -0,0 +1,44 @@
+#include "shape.h"
+#include "intersection.h"
+#include "ray.h"
+#include "ray_packet.h"
+
+IntersectionBuffer Shape::intersept(const Ray &ray) const {
+  IntersectionBuffer xs;
+  localIntersept(ray, xs);
+  return xs;
+}
+
+void Shape::worldIntersept(const Ray &ray, IntersectionBuffer &xs) const {
+  localIntersept(ray * inverseTransformation(), xs);
+}
+
+void Shape::worldInterseptPacket(const RayPacket &rays,
+                                 PacketHit &hits) const {
+  localInterseptPacket(rays * inverseTransformation(), hits);
+}
+
+bool Shape::worldInterseptsBetween(const Ray &ray, float tMin,
+                                   float tMax) const {
+  return interseptsBetween(ray * inverseTransformation(), tMin, tMax);
+}
+
+bool Shape::interseptsBetween(const Ray &ray, float tMin, float tMax) const {
+  for (const auto &i : intersept(ray)) {
+    if (i.t() > tMin && i.t() < tMax) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Shape::localInterseptPacket(const RayPacket &rays, PacketHit &hits) const {
+  for (int lane = 0; lane < RayPacket::s_size; ++lane) {
+    for (const auto &i : intersept(rays.ray(lane))) {
+      if (i.t() > 0.f && i.t() < hits.t[lane]) {
+        hits.t[lane] = i.t();
+        hits.object[lane] = this;
+      }
+    }
+  }
+}
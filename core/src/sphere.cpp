@@ -1,31 +1,138 @@
 #include "sphere.h"
 #include "intersection.h"
 #include "ray.h"
+#include "ray_packet.h"
 #include "tuple.h"
 #include <cmath>
 
-std::vector<Intersection> Sphere::intersept(const Ray &ray) const {
-  const auto sphereToRay = ray.origin() - Point(0, 0, 0);
+namespace {
+// roots t1 <= t2 of |origin + t * direction - center|^2 = radiusSq, false if
+// the ray misses the sphere
+bool roots(const Ray &ray, const point_t &center, float radiusSq, float &t1,
+           float &t2) {
+  const auto sphereToRay = ray.origin() - center;
 
   const auto a = dotProduct(ray.direction(), ray.direction());
   const auto b = 2 * dotProduct(ray.direction(), sphereToRay);
-  const auto c = dotProduct(sphereToRay, sphereToRay) - 1.f;
+  const auto c = dotProduct(sphereToRay, sphereToRay) - radiusSq;
 
   const auto discriminant = b * b - 4 * a * c;
   if (discriminant < 0) {
-    return {};
+    return false;
   }
 
-  const auto t1 = (-b - std::sqrt(discriminant)) / (2 * a);
-  const auto t2 = (-b + std::sqrt(discriminant)) / (2 * a);
-  return {Intersection(t1, shared_from_this()),
-          Intersection(t2, shared_from_this())};
+  t1 = (-b - std::sqrt(discriminant)) / (2 * a);
+  t2 = (-b + std::sqrt(discriminant)) / (2 * a);
+  return true;
+}
+} // namespace
+
+void Sphere::localIntersept(const Ray &ray, IntersectionBuffer &xs) const {
+  float t1, t2;
+  if (roots(ray, Point(0, 0, 0), 1.f, t1, t2)) {
+    xs.emplace_back(t1, this);
+    xs.emplace_back(t2, this);
+  }
+}
+
+void Sphere::worldIntersept(const Ray &ray, IntersectionBuffer &xs) const {
+  const float radius = uniformScale();
+  if (radius == 0.f) {
+    Shape::worldIntersept(ray, xs);
+    return;
+  }
+  // a similarity transformation keeps the sphere a sphere, so the ray is
+  // intersected in world space without transforming it; t is the same in
+  // both spaces
+  float t1, t2;
+  if (roots(ray, center(), radius * radius, t1, t2)) {
+    xs.emplace_back(t1, this);
+    xs.emplace_back(t2, this);
+  }
+}
+
+namespace {
+// four ray version of roots(), with the same operation order so every lane
+// matches the single ray result; lowers hits to the nearest root t > 0
+void closestRoots(const RayPacket &rays, const point_t &center,
+                  float radiusSq, const Shape *sphere, PacketHit &hits) {
+  const Float4 ox = rays.ox - Float4(center.x);
+  const Float4 oy = rays.oy - Float4(center.y);
+  const Float4 oz = rays.oz - Float4(center.z);
+
+  const Float4 a = (rays.dx * rays.dx + rays.dy * rays.dy) + rays.dz * rays.dz;
+  const Float4 b =
+      Float4(2.f) * ((rays.dx * ox + rays.dy * oy) + rays.dz * oz);
+  const Float4 c = ((ox * ox + oy * oy) + oz * oz) - Float4(radiusSq);
+
+  const Float4 discriminant = b * b - Float4(4.f) * a * c;
+  const Mask4 hit = discriminant >= Float4(0.f);
+  if (!hit.any()) {
+    return;
+  }
+
+  const Float4 root = sqrt(discriminant);
+  const Float4 t1 = (-b - root) / (Float4(2.f) * a);
+  const Float4 t2 = (-b + root) / (Float4(2.f) * a);
+  // t1 <= t2, the far root only counts if the near one is behind the origin
+  const Float4 zero(0.f);
+  const Float4 t = select(t1 > zero, t1, t2);
+  hits.update(hit && t > zero && t < Float4::load(hits.t), t, sphere);
+}
+} // namespace
+
+void Sphere::localInterseptPacket(const RayPacket &rays,
+                                  PacketHit &hits) const {
+  closestRoots(rays, Point(0, 0, 0), 1.f, this, hits);
+}
+
+void Sphere::worldInterseptPacket(const RayPacket &rays,
+                                  PacketHit &hits) const {
+  const float radius = uniformScale();
+  if (radius == 0.f) {
+    Shape::worldInterseptPacket(rays, hits);
+    return;
+  }
+  closestRoots(rays, center(), radius * radius, this, hits);
+}
+
+bool Sphere::interseptsBetween(const Ray &ray, float tMin, float tMax) const {
+  float t1, t2;
+  return roots(ray, Point(0, 0, 0), 1.f, t1, t2) &&
+         ((t1 > tMin && t1 < tMax) || (t2 > tMin && t2 < tMax));
+}
+
+bool Sphere::worldInterseptsBetween(const Ray &ray, float tMin,
+                                    float tMax) const {
+  const float radius = uniformScale();
+  if (radius == 0.f) {
+    return Shape::worldInterseptsBetween(ray, tMin, tMax);
+  }
+  float t1, t2;
+  return roots(ray, center(), radius * radius, t1, t2) &&
+         ((t1 > tMin && t1 < tMax) || (t2 > tMin && t2 < tMax));
+}
+
+point_t Sphere::center() const {
+  const Mat44 &m = transformation();
+  return Point(m(0, 3), m(1, 3), m(2, 3));
+}
+
+vector_t Sphere::worldNormalsAt(const point_t &worldPoint) const {
+  if (uniformScale() == 0.f) {
+    return Shape::worldNormalsAt(worldPoint);
+  }
+  return (worldPoint - center()).normalize();
 }
 
 vector_t Sphere::localNormalsAt(const point_t &objectPoint) const {
   return objectPoint - Point(0, 0, 0);
 };
 
+BoundingBox Sphere::bounds() const {
+  return BoundingBox(Point(-1, -1, -1), Point(1, 1, 1));
+}
+
 bool Sphere::operator==(const Shape &other) const {
   const Sphere *s = dynamic_cast<const Sphere *>(&other);
   return s && Shape::operator==(other);
@@ -0,0 +1,147 @@
+#include "sphere_block.h"
+#include "ray.h"
+#include "shape.h"
+#include <cassert>
+
+SphereBlock::SphereBlock() {
+  // unused lanes are masked out, the values only have to be finite
+  for (auto &row : m_) {
+    for (auto &value : row) {
+      value = 0.f;
+    }
+  }
+  for (uint32_t lane = 0; lane < s_size; ++lane) {
+    cx_[lane] = cy_[lane] = cz_[lane] = 0.f;
+    radiusSq_[lane] = 1.f;
+    analytic_[lane] = 0.f;
+    spheres_[lane] = nullptr;
+  }
+}
+
+void SphereBlock::add(const Shape *sphere) {
+  assert(!full());
+  const Mat44 &inverse = sphere->inverseTransformation();
+  for (uint8_t row = 0; row < 3; ++row) {
+    for (uint8_t col = 0; col < 4; ++col) {
+      m_[row * 4 + col][size_] = inverse(row, col);
+    }
+  }
+  // spheres with a similarity transformation are intersected in world space,
+  // like Sphere::worldIntersept() does
+  if (const float radius = sphere->uniformScale(); radius != 0.f) {
+    const Mat44 &m = sphere->transformation();
+    cx_[size_] = m(0, 3);
+    cy_[size_] = m(1, 3);
+    cz_[size_] = m(2, 3);
+    radiusSq_[size_] = radius * radius;
+    analytic_[size_] = 1.f;
+    analyticLanes_ |= 1u << size_;
+  }
+  spheres_[size_] = sphere;
+  if (sphere->castShadows()) {
+    castsShadows_ |= 1u << size_;
+  }
+  ++size_;
+}
+
+Mask8 SphereBlock::roots(const Ray &ray, Float8 &t1, Float8 &t2) const {
+  const uint32_t used = (1u << size_) - 1;
+  if ((analyticLanes_ & used) == used) {
+    return worldRoots(ray, t1, t2);
+  }
+  if (analyticLanes_ == 0) {
+    return objectRoots(ray, t1, t2);
+  }
+  Float8 w1, w2;
+  const Mask8 worldHit = worldRoots(ray, w1, w2);
+  const Mask8 objectHit = objectRoots(ray, t1, t2);
+  const Mask8 analytic = Float8::load(analytic_) > Float8(0.f);
+  t1 = select(analytic, w1, t1);
+  t2 = select(analytic, w2, t2);
+  return (analytic && worldHit) || (!analytic && objectHit);
+}
+
+Mask8 SphereBlock::worldRoots(const Ray &ray, Float8 &t1, Float8 &t2) const {
+  // Sphere::worldIntersept() with the same operation order
+  const Float8 ox = Float8(ray.origin().x) - Float8::load(cx_);
+  const Float8 oy = Float8(ray.origin().y) - Float8::load(cy_);
+  const Float8 oz = Float8(ray.origin().z) - Float8::load(cz_);
+  const Float8 dx(ray.direction().x), dy(ray.direction().y),
+      dz(ray.direction().z);
+
+  const Float8 a(dotProduct(ray.direction(), ray.direction()));
+  const Float8 b = Float8(2.f) * ((dx * ox + dy * oy) + dz * oz);
+  const Float8 c = ((ox * ox + oy * oy) + oz * oz) - Float8::load(radiusSq_);
+
+  const Float8 discriminant = b * b - Float8(4.f) * a * c;
+  const Float8 root = sqrt(discriminant);
+  t1 = (-b - root) / (Float8(2.f) * a);
+  t2 = (-b + root) / (Float8(2.f) * a);
+  return discriminant >= Float8(0.f);
+}
+
+Mask8 SphereBlock::objectRoots(const Ray &ray, Float8 &t1, Float8 &t2) const {
+  const Float8 px(ray.origin().x), py(ray.origin().y), pz(ray.origin().z);
+  const Float8 vx(ray.direction().x), vy(ray.direction().y),
+      vz(ray.direction().z);
+  const auto m = [this](int row, int col) {
+    return Float8::load(m_[row * 4 + col]);
+  };
+
+  // the ray in object space, ordered like Mat44::transformPoint() and
+  // transformVector()
+  const Float8 ox = m(0, 0) * px + m(0, 1) * py + m(0, 2) * pz + m(0, 3);
+  const Float8 oy = m(1, 0) * px + m(1, 1) * py + m(1, 2) * pz + m(1, 3);
+  const Float8 oz = m(2, 0) * px + m(2, 1) * py + m(2, 2) * pz + m(2, 3);
+  const Float8 dx = m(0, 0) * vx + m(0, 1) * vy + m(0, 2) * vz;
+  const Float8 dy = m(1, 0) * vx + m(1, 1) * vy + m(1, 2) * vz;
+  const Float8 dz = m(2, 0) * vx + m(2, 1) * vy + m(2, 2) * vz;
+
+  // Sphere::localIntersept() with the same operation order
+  const Float8 a = (dx * dx + dy * dy) + dz * dz;
+  const Float8 b = Float8(2.f) * ((dx * ox + dy * oy) + dz * oz);
+  const Float8 c = ((ox * ox + oy * oy) + oz * oz) - Float8(1.f);
+
+  const Float8 discriminant = b * b - Float8(4.f) * a * c;
+  const Float8 root = sqrt(discriminant);
+  t1 = (-b - root) / (Float8(2.f) * a);
+  t2 = (-b + root) / (Float8(2.f) * a);
+  return discriminant >= Float8(0.f);
+}
+
+void SphereBlock::closestHit(const Ray &ray, float &tMax,
+                             const Shape *&object) const {
+  Float8 t1, t2;
+  const Mask8 hit = roots(ray, t1, t2);
+  if (!hit.any()) {
+    return;
+  }
+
+  // t1 <= t2, the far root only counts if the near one is behind the origin
+  const Float8 zero(0.f);
+  const Float8 t = select(t1 > zero, t1, t2);
+  int lanes = (hit && t > zero && t < Float8(tMax)).bits() &
+              ((1 << size_) - 1);
+  if (lanes == 0) {
+    return;
+  }
+
+  // lanes in sphere order, so equal distances resolve like the scalar path
+  alignas(32) float ts[s_size];
+  t.store(ts);
+  for (uint32_t lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+    if ((lanes & 1) && ts[lane] < tMax) {
+      tMax = ts[lane];
+      object = spheres_[lane];
+    }
+  }
+}
+
+bool SphereBlock::interseptsBetween(const Ray &ray, float tMin,
+                                    float tMax) const {
+  Float8 t1, t2;
+  const Mask8 hit = roots(ray, t1, t2);
+  const Float8 lo(tMin), hi(tMax);
+  const Mask8 inside = (t1 > lo && t1 < hi) || (t2 > lo && t2 < hi);
+  return ((hit && inside).bits() & castsShadows_) != 0;
+}
@@ -4,18 +4,24 @@
 #include "intersection.h"
 #include "lightning.h"
 #include "ray.h"
+#include "ray_packet.h"
 #include "sphere.h"
 #include "transformations.h"
 #include "tuple.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <iostream>
 
-void World::addObject(const ShapePtr &object) { objects_.push_back(object); }
+void World::addObject(const ShapePtr &object) {
+  objects_.push_back(object);
+  bvhValid_ = false;
+}
 
 void World::removeObject(const ShapePtr &object) {
   objects_.erase(std::remove(objects_.begin(), objects_.end(), object),
                  objects_.end());
+  bvhValid_ = false;
 }
 
 bool World::containsObject(const ShapePtr &object) const {
@@ -44,10 +50,52 @@ bool World::containsLight(const PointLight &light) const {
 void World::clear() {
   objects_.clear();
   lights_.clear();
+  bvhValid_ = false;
 }
 
 bool World::isEmpty() const { return objects_.empty() && lights_.empty(); }
 
+BoundingBox World::bounds() const {
+  BoundingBox box;
+  for (const auto &object : objects_) {
+    if (object->isBounded()) {
+      box.extend(object->worldBounds());
+    }
+  }
+  return box;
+}
+
+const BVH &World::bvh() const {
+  const uint64_t latest = Shape::latestGeneration();
+  if (bvhValid_ && latest != bvhGeneration_) {
+    // some shape changed since the build, maybe one of another world
+    for (const auto &object : objects_) {
+      if (object->generation() > bvhGeneration_) {
+        bvhValid_ = false;
+        break;
+      }
+    }
+    bvhGeneration_ = latest;
+  }
+  if (!bvhValid_) {
+    bvh_.build(objects_);
+    bvhValid_ = true;
+    bvhGeneration_ = latest;
+  }
+  return bvh_;
+}
+
+void World::prepare() const {
+  for (const auto &object : objects_) {
+    object->inverseTransformation();
+    object->worldBounds();
+    if (const auto &pattern = object->material().pattern()) {
+      pattern->inverseTransformation();
+    }
+  }
+  bvh();
+}
+
 World World::defaultWorld() {
   World w;
 
@@ -68,29 +116,49 @@ World World::defaultWorld() {
   return w;
 }
 
+namespace {
+// lights that can add less than this on top of the ambient term (assuming
+// surface colors in [0, 1]) are shaded as if they were occluded, which saves
+// their shadow ray
+constexpr float s_minLightContribution = 1.f / 512.f;
+
+bool contributes(const ComputationData &comps, const PointLight &light) {
+  // facing away from the light leaves only the ambient term, whether the
+  // point is in shadow or not
+  const auto lightVec = light.position() - comps.overPoint;
+  if (dotProduct(lightVec, comps.normalV) < 0.f) {
+    return false;
+  }
+  const Color &intensity = light.intensity();
+  const float peak = std::max({intensity.r(), intensity.g(), intensity.b()});
+  const Material &material = comps.object->material();
+  return peak * (material.diffuse() + material.specular()) >=
+         s_minLightContribution;
+}
+} // namespace
+
 Color World::shadeHit(const ComputationData &comps,
                       uint8_t recursion_limit) const {
-  Color result{0, 0, 0};
+  const Material &material = comps.object->material();
+
+  Color surface{0, 0, 0};
   for (const auto &light : lights_) {
-    bool shadowed = isShadowed(comps.overPoint);
-
-    Color surface =
-        lightining(comps.object->material(), comps.object, light,
-                   comps.overPoint, comps.eyeV, comps.normalV, shadowed);
-
-    Color reflected = reflectedColor(comps, recursion_limit);
-    Color refracted = reflactedColor(comps, recursion_limit);
-    const Material &material = comps.object->material();
-
-    if (material.reflective() > 0.f && material.transparency() > 0.f) {
-      float reflectance = schlick(comps);
-      result = result + surface + reflected * reflectance +
-               refracted * (1.f - reflectance);
-    } else {
-      result = result + surface + reflected + refracted;
-    }
+    const bool shadowed =
+        !contributes(comps, light) || isShadowed(comps.overPoint, light);
+    surface = surface + lightining(material, comps.object, light,
+                                   comps.overPoint, comps.eyeV, comps.normalV,
+                                   shadowed);
+  }
+
+  // secondary rays do not depend on the lights, trace them once per hit
+  const Color reflected = reflectedColor(comps, recursion_limit);
+  const Color refracted = reflactedColor(comps, recursion_limit);
+
+  if (material.reflective() > 0.f && material.transparency() > 0.f) {
+    const float reflectance = schlick(comps);
+    return surface + reflected * reflectance + refracted * (1.f - reflectance);
   }
-  return result;
+  return surface + reflected + refracted;
 }
 
 Color World::reflectedColor(const ComputationData &comps,
@@ -99,8 +167,9 @@ Color World::reflectedColor(const ComputationData &comps,
     return Color(0, 0, 0);
   }
 
+  // the reflected ray stays in the medium the incoming ray came through
   const Ray reflectRay{comps.overPoint, comps.reflectiveV};
-  return colorAt(reflectRay, --recursion_limit) *
+  return colorAt(reflectRay, --recursion_limit, comps.media) *
          comps.object->material().reflective();
 }
 
@@ -121,33 +190,47 @@ Color World::reflactedColor(const ComputationData &comps,
   const vector_t direction =
       comps.normalV * (n_ratio * cos_i - cos_t) - comps.eyeV * n_ratio;
 
+  MediumStack media = comps.media;
+  media.cross(comps.object);
+
   const Ray reflectedRay{comps.underPoint, direction};
-  return colorAt(reflectedRay, recursionLimit - 1) *
+  return colorAt(reflectedRay, recursionLimit - 1, media) *
          comps.object->material().transparency();
 }
 
-Color World::colorAt(const Ray &r, uint8_t recursion_limit) const {
-  const auto xs = r.intersept(*this);
-  const auto h = hit(xs);
+Color World::colorAt(const Ray &r, uint8_t recursion_limit,
+                     const MediumStack &media) const {
+  const auto h = r.closestHit(*this);
   if (!h.has_value()) {
     return Color(0, 0, 0);
   }
-  const auto comps = r.precompute(h.value(), xs);
-  return shadeHit(comps, recursion_limit);
+  return shadeHit(r.precompute(h.value(), media), recursion_limit);
 }
 
-bool World::isShadowed(point_t point) const {
-  // TO-DO: support multiple light source
-  const auto v = lights_[0].position() - point;
+void World::colorAt(const RayPacket &rays, Color (&colors)[4],
+                    uint8_t recursionLimit) const {
+  const PacketHit hits = rays.closestHits(*this);
+  for (int lane = 0; lane < RayPacket::s_size; ++lane) {
+    if (!hits.object[lane]) {
+      colors[lane] = Color(0, 0, 0);
+      continue;
+    }
+    const Ray r = rays.ray(lane);
+    const Intersection h(hits.t[lane], hits.object[lane]);
+    colors[lane] = shadeHit(r.precompute(h), recursionLimit);
+  }
+}
+
+bool World::isShadowed(point_t point, const PointLight &light) const {
+  const auto v = light.position() - point;
 
   const auto distance = v.magnitude();
   const auto direction = v.normalize();
 
   const Ray r{point, direction};
-  const auto xs = r.intersept(*this);
-  const auto h = hit(xs);
-  if (h && h->t() < distance) {
-    return true;
-  }
-  return false;
+  return r.isOccluded(*this, distance);
+}
+
+bool World::isShadowed(point_t point) const {
+  return !lights_.empty() && isShadowed(point, lights_.front());
 }
@@ -0,0 +1,67 @@
+#include "bounding_box.h"
+#include "transformations.h"
+#include "tuple.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <limits>
+
+TEST_CASE("bounding box - default constructor") {
+  const auto box = BoundingBox();
+  REQUIRE(box.isEmpty());
+  REQUIRE_FALSE(box.isInfinite());
+  REQUIRE(box.surfaceArea() == 0.f);
+}
+
+TEST_CASE("bounding box - extend()") {
+  auto box = BoundingBox();
+  box.extend(Point(-5, 2, 0));
+  box.extend(Point(7, 0, -3));
+  REQUIRE(box.min == Point(-5, 0, -3));
+  REQUIRE(box.max == Point(7, 2, 0));
+
+  auto other = BoundingBox(Point(8, -7, -2), Point(14, 4, 8));
+  box.extend(other);
+  REQUIRE(box.min == Point(-5, -7, -3));
+  REQUIRE(box.max == Point(14, 4, 8));
+  REQUIRE(box.contains(Point(0, 0, 0)));
+  REQUIRE_FALSE(box.contains(Point(15, 0, 0)));
+}
+
+TEST_CASE("bounding box - infinite()") {
+  const auto box = BoundingBox::infinite();
+  REQUIRE(box.isInfinite());
+  REQUIRE_FALSE(box.isEmpty());
+  REQUIRE(box.transform(scaling(2, 2, 2)).isInfinite());
+}
+
+TEST_CASE("bounding box - transform()") {
+  const auto box = BoundingBox(Point(-1, -1, -1), Point(1, 1, 1));
+  const auto t = box.transform(rotationX(M_PI / 4) * rotationY(M_PI / 4));
+  REQUIRE(t.min == Point(-1.41421, -1.70711, -1.70711));
+  REQUIRE(t.max == Point(1.41421, 1.70711, 1.70711));
+
+  const auto moved = box.transform(translation(1, 2, 3) * scaling(2, 2, 2));
+  REQUIRE(moved.min == Point(-1, 0, 1));
+  REQUIRE(moved.max == Point(3, 4, 5));
+  REQUIRE(moved.centroid() == Point(1, 2, 3));
+  REQUIRE(moved.surfaceArea() == Approx(96.f));
+}
+
+TEST_CASE("bounding box - intersects()") {
+  const auto box = BoundingBox(Point(5, -2, 0), Point(11, 4, 7));
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  auto hits = [&](const point_t &origin, const vector_t &direction) {
+    const auto inv = Vector(1 / direction.x, 1 / direction.y, 1 / direction.z);
+    return box.intersects(origin, inv, 0.f, inf);
+  };
+
+  REQUIRE(hits(Point(15, 1, 2), Vector(-1, 0, 0)));
+  REQUIRE(hits(Point(-5, -1, 4), Vector(1, 0, 0)));
+  REQUIRE(hits(Point(7, 6, 5), Vector(0, -1, 0)));
+  REQUIRE(hits(Point(8, 1, 3.5), Vector(0, 0, 1)));
+  REQUIRE_FALSE(hits(Point(9, -1, -8), Vector(2, 4, 6).normalize()));
+  REQUIRE_FALSE(hits(Point(8, 3, -4), Vector(6, 2, 4).normalize()));
+  REQUIRE_FALSE(hits(Point(12, 5, 4), Vector(-1, 0, 0)));
+  // box behind the origin
+  REQUIRE_FALSE(hits(Point(15, 1, 2), Vector(1, 0, 0)));
+}
@@ -0,0 +1,106 @@
+#include "bvh.h"
+#include "plane.h"
+#include "ray.h"
+#include "sphere.h"
+#include "transformations.h"
+#include "world.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+std::vector<Intersection> bruteForce(const Ray &r, const World &w) {
+  std::vector<Intersection> xs;
+  for (const auto &object : w.objects()) {
+    const auto objectXs = r.intersept(object);
+    xs.insert(xs.end(), objectXs.begin(), objectXs.end());
+  }
+  std::sort(xs.begin(), xs.end());
+  return xs;
+}
+
+World sphereGrid(int n) {
+  World w;
+  for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+      for (int z = 0; z < n; ++z) {
+        auto s = std::make_shared<Sphere>();
+        s->setTransformation(translation(x * 3.f, y * 3.f, z * 3.f) *
+                             scaling(.5f + .1f * (x % 3), 1, 1));
+        w.addObject(s);
+      }
+    }
+  }
+  return w;
+}
+} // namespace
+
+TEST_CASE("bvh - build()") {
+  SECTION("empty") {
+    BVH bvh;
+    bvh.build({});
+    REQUIRE(bvh.nodeCount() == 0);
+    REQUIRE(bvh.unbounded().empty());
+  }
+
+  SECTION("unbounded objects are kept apart") {
+    auto w = World::defaultWorld();
+    auto floor = std::make_shared<Plane>();
+    w.addObject(floor);
+    const auto &bvh = w.bvh();
+    REQUIRE(bvh.unbounded().size() == 1);
+    REQUIRE(bvh.unbounded()[0] == floor);
+    REQUIRE(bvh.bounded().size() == 2);
+  }
+
+  SECTION("every bounded object is stored once") {
+    const auto w = sphereGrid(6);
+    const auto &bvh = w.bvh();
+    REQUIRE(bvh.bounded().size() == w.objects().size());
+    REQUIRE(bvh.nodeCount() > 1);
+    for (const auto &object : w.objects()) {
+      REQUIRE(std::count(bvh.bounded().begin(), bvh.bounded().end(), object) ==
+              1);
+    }
+  }
+}
+
+TEST_CASE("bvh - traverse()") {
+  const auto w = sphereGrid(6);
+  const Ray rays[] = {
+      Ray(Point(-5, 0, 0), Vector(1, 0, 0)),
+      Ray(Point(7.5, 7.5, -10), Vector(0, 0, 1)),
+      Ray(Point(-3, -3, -3), Vector(1, 1, 1).normalize()),
+      Ray(Point(20, 4, 8), Vector(-1, .1f, -.2f).normalize()),
+      Ray(Point(6, 6, 6), Vector(0, -1, 0)),
+      Ray(Point(100, 100, 100), Vector(1, 0, 0)),
+  };
+  for (const auto &r : rays) {
+    const auto expected = bruteForce(r, w);
+    const auto xs = r.intersept(w);
+    REQUIRE(xs.size() == expected.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      REQUIRE(xs[i].t() == expected[i].t());
+    }
+  }
+}
+
+TEST_CASE("bvh - invalidation") {
+  auto w = World::defaultWorld();
+  const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
+  REQUIRE(r.intersept(w).size() == 4);
+
+  auto s = std::make_shared<Sphere>();
+  s->setTransformation(translation(0, 0, 5));
+  w.addObject(s);
+  REQUIRE(r.intersept(w).size() == 6);
+
+  w.removeObject(s);
+  REQUIRE(r.intersept(w).size() == 4);
+
+  w.objects().push_back(s);
+  REQUIRE(r.intersept(w).size() == 6);
+}
@@ -1,12 +1,18 @@
 #include "camera.h"
 #include "color.h"
 #include "matrix.h"
+#include "ray_packet.h"
+#include "row_sink.h"
 #include "transformations.h"
 #include "tuple.h"
 #include <catch2/catch.hpp>
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 TEST_CASE("camera - constructor") {
   const uint32_t hsize = 160;
@@ -53,6 +59,52 @@ TEST_CASE("camera - rayForPixel()") {
     REQUIRE(r.origin() == Point(0, 2, -5));
     REQUIRE(r.direction() == Vector(std::sqrt(2) / 2, 0, -std::sqrt(2) / 2));
   }
+
+  SECTION("cached view follows a new transformation") {
+    auto c = Camera(201, 101, M_PI / 2);
+    REQUIRE(c.rayForPixel(100, 50).origin() == Point(0, 0, 0));
+    c.transform() = rotationY(M_PI / 4) * translation(0, -2, 5);
+    REQUIRE(c.rayForPixel(100, 50).origin() == Point(0, 2, -5));
+    c.setTransorm(translation(1, 0, 0));
+    REQUIRE(c.rayForPixel(100, 50).origin() == Point(-1, 0, 0));
+  }
+}
+
+TEST_CASE("camera - batch ray generation") {
+  auto c = Camera(23, 17, M_PI / 3);
+  c.setTransorm(view(Point(1, 2, -5), Point(0, 1, 0), Vector(0, 1, 0)));
+
+  SECTION("raysForTile()") {
+    std::vector<Ray> rays;
+    c.raysForTile(3, 4, 10, 7, rays);
+    REQUIRE(rays.size() == 21);
+    auto ray = rays.begin();
+    for (uint32_t y = 4; y < 7; ++y) {
+      for (uint32_t x = 3; x < 10; ++x, ++ray) {
+        const auto expected = c.rayForPixel(x, y);
+        REQUIRE(ray->origin().x == expected.origin().x);
+        REQUIRE(ray->origin().y == expected.origin().y);
+        REQUIRE(ray->origin().z == expected.origin().z);
+        REQUIRE(ray->direction().x == expected.direction().x);
+        REQUIRE(ray->direction().y == expected.direction().y);
+        REQUIRE(ray->direction().z == expected.direction().z);
+      }
+    }
+  }
+
+  SECTION("packetForPixels()") {
+    const uint32_t xs[4] = {0, 22, 5, 5};
+    const uint32_t ys[4] = {0, 16, 9, 10};
+    const auto packet = c.packetForPixels(xs, ys);
+    for (int i = 0; i < 4; ++i) {
+      const auto expected = c.rayForPixel(xs[i], ys[i]);
+      const auto ray = packet.ray(i);
+      REQUIRE(ray.origin().x == expected.origin().x);
+      REQUIRE(ray.direction().x == expected.direction().x);
+      REQUIRE(ray.direction().y == expected.direction().y);
+      REQUIRE(ray.direction().z == expected.direction().z);
+    }
+  }
 }
 
 TEST_CASE("camera - render()") {
@@ -75,3 +127,99 @@ TEST_CASE("camera - render()") {
   // std::cout << c.transform() << std::endl;
   REQUIRE(image(5, 5) == Color(0.38066, 0.47583, 0.2855));
 }
+
+TEST_CASE("camera - parallel render()") {
+  const auto w = World::defaultWorld();
+  auto c = Camera(37, 23, M_PI / 2);
+  c.setTransorm(view(Point(0, 0, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+  const auto expected = c.render(w);
+
+  SECTION("matches the serial render") {
+    const auto image = c.render(w, RenderOptions{4, 5});
+    for (uint32_t y = 0; y < c.vsize(); ++y) {
+      for (uint32_t x = 0; x < c.hsize(); ++x) {
+        REQUIRE(image(x, y).r() == expected(x, y).r());
+        REQUIRE(image(x, y).g() == expected(x, y).g());
+        REQUIRE(image(x, y).b() == expected(x, y).b());
+      }
+    }
+  }
+
+  SECTION("without ray packets") {
+    const auto image = c.render(w, RenderOptions{4, 5, false});
+    for (uint32_t y = 0; y < c.vsize(); ++y) {
+      for (uint32_t x = 0; x < c.hsize(); ++x) {
+        REQUIRE(image(x, y) == expected(x, y));
+      }
+    }
+  }
+
+  SECTION("single thread and oversized tile") {
+    const auto image = c.render(w, RenderOptions{1, 64});
+    REQUIRE(image(18, 11) == expected(18, 11));
+    REQUIRE(image(0, 0) == expected(0, 0));
+  }
+
+  SECTION("into a memory mapped canvas") {
+    const std::string path = "camera_mapped_test.pfm";
+    {
+      auto image = Canvas::createMappedPFM(path, c.hsize(), c.vsize());
+      c.render(w, RenderOptions{4, 5, false}, image);
+    }
+    const auto image = Canvas::loadPFM(path);
+    std::remove(path.c_str());
+    for (uint32_t y = 0; y < c.vsize(); ++y) {
+      for (uint32_t x = 0; x < c.hsize(); ++x) {
+        REQUIRE(image(x, y) == expected(x, y));
+      }
+    }
+    auto small = Canvas(c.hsize(), c.vsize() - 1);
+    REQUIRE_THROWS_AS(c.render(w, RenderOptions{}, small),
+                      std::invalid_argument);
+  }
+}
+
+namespace {
+// keeps every row it receives; writeRows() runs on the render workers, so
+// the order is only recorded and checked afterwards
+class RecordingSink : public RowSink {
+public:
+  void writeRows(uint32_t y, uint32_t count, const Color *pixels) override {
+    inOrder_ = inOrder_ && y == rows_.size() / width();
+    rows_.insert(rows_.end(), pixels, pixels + size_t(count) * width());
+  }
+
+  void end() override { ended_ = true; }
+
+  std::vector<Color> rows_;
+  bool inOrder_{true};
+  bool ended_{false};
+};
+} // namespace
+
+TEST_CASE("camera - streaming render()") {
+  const auto w = World::defaultWorld();
+  auto c = Camera(37, 23, M_PI / 2);
+  c.setTransorm(view(Point(0, 0, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+  const auto expected = c.render(w);
+
+  const uint32_t threads = GENERATE(1u, 4u);
+  const uint32_t window = GENERATE(1u, 3u, 100u);
+  const bool packets = GENERATE(true, false);
+  RecordingSink sink;
+  c.render(w, RenderOptions{threads, 5, packets, window}, sink);
+
+  REQUIRE(sink.ended_);
+  REQUIRE(sink.inOrder_);
+  REQUIRE(sink.width() == c.hsize());
+  REQUIRE(sink.height() == c.vsize());
+  REQUIRE(sink.rows_.size() == size_t(c.hsize()) * c.vsize());
+  for (uint32_t y = 0; y < c.vsize(); ++y) {
+    for (uint32_t x = 0; x < c.hsize(); ++x) {
+      const auto &color = sink.rows_[size_t(y) * c.hsize() + x];
+      REQUIRE(color.r() == expected(x, y).r());
+      REQUIRE(color.g() == expected(x, y).g());
+      REQUIRE(color.b() == expected(x, y).b());
+    }
+  }
+}
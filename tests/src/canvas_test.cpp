@@ -1,12 +1,25 @@
 #include "canvas.h"
+#include "pixel_format.h"
 #include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 TEST_CASE("canvas - Constructor") {
   const Canvas c = Canvas(10, 20);
   REQUIRE(c.width() == 10);
   REQUIRE(c.height() == 20);
-  for (auto &v : c.pixels()) {
-    REQUIRE(v == Color(0, 0, 0));
+  REQUIRE(c.format() == PixelFormat::RGB32F);
+  for (uint32_t y = 0; y < c.height(); ++y) {
+    for (uint32_t x = 0; x < c.width(); ++x) {
+      REQUIRE(c(x, y) == Color(0, 0, 0));
+    }
   }
 }
 
@@ -63,3 +76,334 @@ TEST_CASE("canvas - getAsPPM") {
     REQUIRE(ppm.at(ppm.size() - 1) == '\n');
   }
 }
+
+namespace {
+std::string readAll(std::FILE *file) {
+  std::rewind(file);
+  std::string content;
+  char buffer[4096];
+  size_t n;
+  while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    content.append(buffer, n);
+  }
+  return content;
+}
+} // namespace
+
+TEST_CASE("canvas - writePPM") {
+  SECTION("header and binary pixels") {
+    auto canvas = Canvas(5, 3);
+    canvas.writePixel(0, 0, Color(1.5, 0, 0));
+    canvas.writePixel(2, 1, Color(0, 0.5, 0));
+    canvas.writePixel(4, 2, Color(-0.5, 0, 1));
+
+    std::FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    canvas.writePPM(fileno(file));
+    const auto ppm = readAll(file);
+    std::fclose(file);
+
+    const std::string header = "P6\n5 3\n255\n";
+    REQUIRE(ppm.size() == header.size() + 5 * 3 * 3);
+    REQUIRE(ppm.substr(0, header.size()) == header);
+    const auto *bytes =
+        reinterpret_cast<const uint8_t *>(ppm.data() + header.size());
+    REQUIRE(bytes[0] == 255);
+    REQUIRE(bytes[(1 * 5 + 2) * 3 + 1] == 128);
+    REQUIRE(bytes[(2 * 5 + 4) * 3 + 0] == 0);
+    REQUIRE(bytes[(2 * 5 + 4) * 3 + 2] == 255);
+  }
+
+  SECTION("same channel values as getAsPPM()") {
+    // values around every rounding boundary, including ones just below .5
+    auto canvas = Canvas(37, 7);
+    uint32_t i = 0;
+    for (uint32_t y = 0; y < canvas.height(); ++y) {
+      for (uint32_t x = 0; x < canvas.width(); ++x, ++i) {
+        const float boundary = (i % 256 + .5f) / 255.f;
+        canvas.writePixel(x, y,
+                          Color(std::nextafter(boundary, 0.f), boundary,
+                                i * .01f - .3f));
+      }
+    }
+
+    std::FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    canvas.writePPM(fileno(file));
+    const auto binary = readAll(file);
+    std::fclose(file);
+
+    std::istringstream plain(canvas.getAsPPM().substr(11));
+    const size_t offset = std::string("P6\n37 7\n255\n").size();
+    REQUIRE(binary.size() == offset + 37 * 7 * 3);
+    for (size_t b = offset; b < binary.size(); ++b) {
+      int value;
+      plain >> value;
+      REQUIRE(uint8_t(binary[b]) == value);
+    }
+  }
+
+  SECTION("save() picks the format from the extension") {
+    const auto canvas = Canvas(2, 2);
+    REQUIRE_THROWS_AS(canvas.save("image.bmp"), std::invalid_argument);
+    const std::string base = "canvas_save_test";
+    for (const auto &[extension, magic] :
+         {std::pair{".ppm", "P6"}, {".qoi", "qoif"}, {".png", "\x89PNG"},
+          {".pfm", "PF"}}) {
+      const auto path = base + extension;
+      canvas.save(path);
+      std::FILE *file = std::fopen(path.c_str(), "rb");
+      REQUIRE(file != nullptr);
+      const auto content = readAll(file);
+      std::fclose(file);
+      std::remove(path.c_str());
+      REQUIRE(content.substr(0, std::string(magic).size()) == magic);
+    }
+  }
+
+  SECTION("savePPM() reports unwritable paths") {
+    const auto canvas = Canvas(2, 2);
+    REQUIRE_THROWS_AS(canvas.savePPM("/nonexistent/dir/image.ppm"),
+                      std::runtime_error);
+  }
+}
+
+TEST_CASE("canvas - pixel formats") {
+  const Color colors[] = {Color(0, 0, 0), Color(1, .5f, .25f),
+                          Color(.1f, .2f, .3f), Color(2.5f, -1, 1000)};
+
+  SECTION("RGB32F is lossless") {
+    auto canvas = Canvas(4, 1, PixelFormat::RGB32F);
+    canvas.writePixels(0, 0, colors);
+    for (uint32_t x = 0; x < 4; ++x) {
+      REQUIRE(canvas(x, 0).r() == colors[x].r());
+      REQUIRE(canvas(x, 0).g() == colors[x].g());
+      REQUIRE(canvas(x, 0).b() == colors[x].b());
+    }
+  }
+
+  SECTION("RGB16F keeps about three digits") {
+    auto canvas = Canvas(4, 1, PixelFormat::RGB16F);
+    canvas.writePixels(0, 0, colors);
+    Color read[4];
+    canvas.readPixels(0, 0, read);
+    for (uint32_t x = 0; x < 4; ++x) {
+      REQUIRE(read[x].r() == Approx(colors[x].r()).epsilon(1e-3));
+      REQUIRE(read[x].g() == Approx(colors[x].g()).epsilon(1e-3));
+      REQUIRE(read[x].b() == Approx(colors[x].b()).epsilon(1e-3));
+    }
+  }
+
+  SECTION("SRGB8 stores the quantized bytes") {
+    auto canvas = Canvas(4, 1, PixelFormat::SRGB8);
+    canvas.writePixels(0, 0, colors);
+    REQUIRE(canvas(1, 0) == Color(1, 128 / 255.f, 64 / 255.f));
+    REQUIRE(canvas(3, 0) == Color(1, 0, 1));
+  }
+
+  SECTION("PPM output does not depend on 8 bit storage") {
+    auto full = Canvas(13, 5);
+    auto bytes = Canvas(13, 5, PixelFormat::SRGB8);
+    for (uint32_t y = 0; y < 5; ++y) {
+      for (uint32_t x = 0; x < 13; ++x) {
+        const auto c = Color(x / 13.f, y / 5.f, (x * y % 7) / 6.f);
+        full.writePixel(x, y, c);
+        bytes.writePixel(x, y, c);
+      }
+    }
+    REQUIRE(bytes.getAsPPM() == full.getAsPPM());
+
+    std::FILE *fullFile = std::tmpfile();
+    std::FILE *bytesFile = std::tmpfile();
+    full.writePPM(fileno(fullFile));
+    bytes.writePPM(fileno(bytesFile));
+    REQUIRE(readAll(bytesFile) == readAll(fullFile));
+    std::fclose(fullFile);
+    std::fclose(bytesFile);
+  }
+
+  SECTION("out of range access") {
+    auto canvas = Canvas(4, 2, PixelFormat::RGB16F);
+    REQUIRE_THROWS_AS(canvas.writePixels(2, 1, colors), std::out_of_range);
+    REQUIRE_THROWS_AS(canvas.writePixel(0, 2, colors[0]), std::out_of_range);
+    REQUIRE_THROWS_AS(canvas(4, 0), std::out_of_range);
+  }
+}
+
+TEST_CASE("pixel format - half floats") {
+  REQUIRE(floatToHalf(0.f) == 0x0000);
+  REQUIRE(floatToHalf(-0.f) == 0x8000);
+  REQUIRE(floatToHalf(1.f) == 0x3c00);
+  REQUIRE(floatToHalf(-2.f) == 0xc000);
+  REQUIRE(floatToHalf(65504.f) == 0x7bff);
+  REQUIRE(floatToHalf(65520.f) == 0x7c00);
+  REQUIRE(floatToHalf(std::ldexp(1.f, -24)) == 0x0001);
+  REQUIRE(floatToHalf(std::ldexp(1.f, -26)) == 0x0000);
+  // ties round to even
+  REQUIRE(floatToHalf(1.f + std::ldexp(1.f, -11)) == 0x3c00);
+  REQUIRE(floatToHalf(1.f + 3 * std::ldexp(1.f, -11)) == 0x3c02);
+  REQUIRE(floatToHalf(std::numeric_limits<float>::infinity()) == 0x7c00);
+  REQUIRE(std::isnan(
+      halfToFloat(floatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+  // every finite half survives the round trip
+  uint32_t mismatches = 0;
+  for (uint32_t h = 0; h < 0x10000; ++h) {
+    if ((h & 0x7c00) != 0x7c00 && floatToHalf(halfToFloat(uint16_t(h))) != h) {
+      ++mismatches;
+    }
+  }
+  REQUIRE(mismatches == 0);
+  REQUIRE(halfToFloat(0x0001) == std::ldexp(1.f, -24));
+  REQUIRE(halfToFloat(0x3555) == Approx(1.f / 3).epsilon(1e-3));
+}
+
+TEST_CASE("canvas - PFM") {
+  SECTION("round trip keeps the unclamped colors") {
+    const auto format = GENERATE(PixelFormat::RGB32F, PixelFormat::RGB16F);
+    auto canvas = Canvas(7, 3, format);
+    for (uint32_t y = 0; y < 3; ++y) {
+      for (uint32_t x = 0; x < 7; ++x) {
+        canvas.writePixel(x, y, Color(x * 10.5f, -.25f * y, 1.f / (x + 1)));
+      }
+    }
+
+    std::FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    canvas.writePFM(fileno(file));
+    const auto pfm = readAll(file);
+    const std::string header = "PF\n7 3\n-1.0\n";
+    REQUIRE(pfm.substr(0, header.size()) == header);
+    REQUIRE(pfm.size() == header.size() + 7 * 3 * 12);
+    // the bottom row comes first
+    float first;
+    std::memcpy(&first, pfm.data() + header.size() + 4, sizeof(first));
+    REQUIRE(first == canvas(0, 2).g());
+
+    std::rewind(file);
+    const auto read = Canvas::readPFM(fileno(file));
+    std::fclose(file);
+    REQUIRE(read.format() == PixelFormat::RGB32F);
+    REQUIRE(read.width() == 7);
+    REQUIRE(read.height() == 3);
+    for (uint32_t y = 0; y < 3; ++y) {
+      for (uint32_t x = 0; x < 7; ++x) {
+        REQUIRE(read(x, y).r() == canvas(x, y).r());
+        REQUIRE(read(x, y).g() == canvas(x, y).g());
+        REQUIRE(read(x, y).b() == canvas(x, y).b());
+      }
+    }
+  }
+
+  SECTION("big endian grayscale map") {
+    std::string pfm = "Pf\n2  1\n1.0\n";
+    // 2.5f and -1.f in big endian
+    pfm += std::string("\x40\x20\x00\x00\xbf\x80\x00\x00", 8);
+    std::FILE *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    std::fwrite(pfm.data(), 1, pfm.size(), file);
+    std::fflush(file);
+    std::rewind(file);
+    const auto read = Canvas::readPFM(fileno(file));
+    std::fclose(file);
+    REQUIRE(read(0, 0) == Color(2.5f, 2.5f, 2.5f));
+    REQUIRE(read(1, 0) == Color(-1.f, -1.f, -1.f));
+  }
+
+  SECTION("malformed input") {
+    for (const std::string bad :
+         {"P6\n1 1\n255\n", "PF\n-1 1\n-1.0\n", "PF\n1 1\n0\n",
+          "PF\n2 1\n-1.0\n0000",
+          // rejected before the pixels are allocated
+          "PF\n999999999 999999999\n-1.0\n0000",
+          "Pf\n999999 1000\n1.0\n00000000"}) {
+      std::FILE *file = std::tmpfile();
+      REQUIRE(file != nullptr);
+      std::fwrite(bad.data(), 1, bad.size(), file);
+      std::fflush(file);
+      std::rewind(file);
+      REQUIRE_THROWS_AS(Canvas::readPFM(fileno(file)), std::runtime_error);
+      std::fclose(file);
+    }
+  }
+}
+
+TEST_CASE("canvas - memory mapped PFM") {
+  const std::string path = "canvas_mapped_test.pfm";
+  const auto color = [](uint32_t x, uint32_t y) {
+    return Color(x * 1.5f, -.5f * y, 1.f / (x + y + 1));
+  };
+  {
+    auto canvas = Canvas::createMappedPFM(path, 5, 3);
+    REQUIRE(canvas.isMapped());
+    REQUIRE(canvas.format() == PixelFormat::RGB32F);
+    REQUIRE(canvas(4, 2) == Color(0, 0, 0));
+    for (uint32_t y = 0; y < 3; ++y) {
+      for (uint32_t x = 0; x < 5; ++x) {
+        canvas.writePixel(x, y, color(x, y));
+      }
+    }
+    REQUIRE(canvas(3, 1) == color(3, 1));
+    REQUIRE_THROWS_AS(canvas.writePixel(5, 0, Color(0, 0, 0)),
+                      std::out_of_range);
+    canvas.sync();
+  }
+  REQUIRE_FALSE(Canvas(1, 1).isMapped());
+
+  SECTION("the file is a PFM with the pixels") {
+    const auto read = Canvas::loadPFM(path);
+    REQUIRE_FALSE(read.isMapped());
+    for (uint32_t y = 0; y < 3; ++y) {
+      for (uint32_t x = 0; x < 5; ++x) {
+        REQUIRE(read(x, y) == color(x, y));
+      }
+    }
+  }
+
+  SECTION("reopened to continue writing") {
+    {
+      auto canvas = Canvas::openMappedPFM(path);
+      REQUIRE(canvas.width() == 5);
+      REQUIRE(canvas.height() == 3);
+      REQUIRE(canvas(2, 2) == color(2, 2));
+      canvas.writePixel(2, 2, Color(7, 8, 9));
+    }
+    const auto read = Canvas::loadPFM(path);
+    REQUIRE(read(2, 2) == Color(7, 8, 9));
+    REQUIRE(read(1, 2) == color(1, 2));
+  }
+
+  SECTION("written like any other canvas") {
+    const auto canvas = Canvas::openMappedPFM(path);
+    auto copy = Canvas(5, 3);
+    for (uint32_t y = 0; y < 3; ++y) {
+      for (uint32_t x = 0; x < 5; ++x) {
+        copy.writePixel(x, y, color(x, y));
+      }
+    }
+    REQUIRE(canvas.getAsPPM() == copy.getAsPPM());
+    std::FILE *mapped = std::tmpfile();
+    std::FILE *plain = std::tmpfile();
+    REQUIRE(mapped != nullptr);
+    REQUIRE(plain != nullptr);
+    canvas.writePPM(fileno(mapped));
+    copy.writePPM(fileno(plain));
+    REQUIRE(readAll(mapped) == readAll(plain));
+    std::fclose(mapped);
+    std::fclose(plain);
+  }
+
+  SECTION("only native color maps can be mapped") {
+    const std::string gray = "canvas_mapped_gray.pfm";
+    std::FILE *file = std::fopen(gray.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    std::fputs("Pf\n1 1\n-1.0\n", file);
+    std::fwrite("\0\0\0\0", 1, 4, file);
+    std::fclose(file);
+    REQUIRE_THROWS_AS(Canvas::openMappedPFM(gray), std::runtime_error);
+    std::remove(gray.c_str());
+    REQUIRE_THROWS_AS(Canvas::openMappedPFM("/nonexistent/image.pfm"),
+                      std::runtime_error);
+  }
+  std::remove(path.c_str());
+}
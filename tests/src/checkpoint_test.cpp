@@ -0,0 +1,101 @@
+#include "camera.h"
+#include "checkpoint.h"
+#include "transformations.h"
+#include "world.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace {
+const std::string s_path = "checkpoint_test.pfm";
+
+void removeCheckpoint() {
+  std::remove(s_path.c_str());
+  std::remove((s_path + ".tiles").c_str());
+}
+} // namespace
+
+TEST_CASE("checkpoint - render and resume") {
+  const auto w = World::defaultWorld();
+  auto c = Camera(37, 23, M_PI / 2);
+  c.setTransorm(view(Point(0, 0, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+  const auto expected = c.render(w, RenderOptions{1, 8, false});
+  const auto options = RenderOptions{4, 8, false};
+
+  SECTION("an uninterrupted render matches the canvas render") {
+    {
+      Checkpoint checkpoint(s_path, 37, 23, 8, false);
+      REQUIRE(checkpoint.tiles() == 15);
+      REQUIRE(checkpoint.remaining().size() == 15);
+      c.render(w, options, checkpoint);
+      REQUIRE(checkpoint.remaining().empty());
+    }
+    const auto image = Canvas::loadPFM(s_path);
+    for (uint32_t y = 0; y < 23; ++y) {
+      for (uint32_t x = 0; x < 37; ++x) {
+        REQUIRE(image(x, y) == expected(x, y));
+      }
+    }
+    // nothing is left to do on resume
+    Checkpoint checkpoint(s_path, 37, 23, 8, true);
+    REQUIRE(checkpoint.remaining().empty());
+  }
+
+  SECTION("resume skips finished tiles and completes the rest") {
+    const Color marker(7, 7, 7);
+    {
+      // an interrupted render: tiles 0-5 done, saved, then killed
+      Checkpoint checkpoint(s_path, 37, 23, 8, false,
+                            std::chrono::milliseconds(0));
+      for (size_t tile = 0; tile < 6; ++tile) {
+        const uint32_t x0 = tile % 5 * 8, y0 = tile / 5 * 8;
+        for (uint32_t y = y0; y < std::min(y0 + 8, 23u); ++y) {
+          for (uint32_t x = x0; x < std::min(x0 + 8, 37u); ++x) {
+            checkpoint.image().writePixel(x, y, marker);
+          }
+        }
+        checkpoint.finish(tile);
+      }
+    }
+
+    Checkpoint checkpoint(s_path, 37, 23, 8, true);
+    REQUIRE(checkpoint.remaining().size() == 9);
+    REQUIRE(checkpoint.remaining().front() == 6);
+    c.render(w, options, checkpoint);
+    REQUIRE(checkpoint.remaining().empty());
+    const auto &image = checkpoint.image();
+    for (uint32_t y = 0; y < 23; ++y) {
+      for (uint32_t x = 0; x < 37; ++x) {
+        const bool finished = y < 8 || (y < 16 && x < 8);
+        REQUIRE(image(x, y) == (finished ? marker : expected(x, y)));
+      }
+    }
+  }
+
+  SECTION("a new checkpoint discards the old progress") {
+    {
+      Checkpoint checkpoint(s_path, 37, 23, 8, false);
+      c.render(w, options, checkpoint);
+    }
+    Checkpoint checkpoint(s_path, 37, 23, 8, false);
+    REQUIRE(checkpoint.remaining().size() == 15);
+    REQUIRE(checkpoint.image()(18, 11) == Color(0, 0, 0));
+  }
+
+  SECTION("resume checks the render") {
+    { Checkpoint checkpoint(s_path, 37, 23, 8, false); }
+    REQUIRE_THROWS_AS(Checkpoint(s_path, 37, 22, 8, true), std::runtime_error);
+    REQUIRE_THROWS_AS(Checkpoint(s_path, 37, 23, 16, true),
+                      std::runtime_error);
+    removeCheckpoint();
+    REQUIRE_THROWS_AS(Checkpoint(s_path, 37, 23, 8, true), std::runtime_error);
+
+    Checkpoint checkpoint(s_path, 36, 23, 8, false);
+    REQUIRE_THROWS_AS(c.render(w, options, checkpoint), std::invalid_argument);
+  }
+  removeCheckpoint();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "canvas.h"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// the file a Sink encodes canvas into; with times > 1 the same sink writes
+// the canvas repeatedly, one complete image after the other
+template <typename Sink>
+std::vector<uint8_t> encode(const Canvas &canvas, int times = 1) {
+  std::FILE *file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  Sink sink(fileno(file));
+  for (int i = 0; i < times; ++i) {
+    canvas.write(sink);
+  }
+  std::rewind(file);
+  std::vector<uint8_t> bytes;
+  int c;
+  while ((c = std::fgetc(file)) != EOF) {
+    bytes.push_back(uint8_t(c));
+  }
+  std::fclose(file);
+  return bytes;
+}
+
+inline uint32_t bigEndian(const uint8_t *p) {
+  return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 |
+         p[3];
+}
@@ -0,0 +1,156 @@
+#include "inline_buffer.h"
+#include "intersection.h"
+#include "scratch_arena.h"
+#include "sphere.h"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+TEST_CASE("InlineBuffer") {
+  SECTION("keeps small lists inline") {
+    InlineBuffer<int, 4> xs{3, 1, 2};
+    REQUIRE(xs.size() == 3);
+    REQUIRE(xs.isInline());
+    REQUIRE(xs[0] == 3);
+    REQUIRE(xs.back() == 2);
+  }
+
+  SECTION("spills to the scratch arena") {
+    const size_t outstanding = ScratchArena::local().outstanding();
+    {
+      InlineBuffer<std::string, 2> xs;
+      for (int i = 0; i < 10; ++i)
+        xs.push_back(std::to_string(i));
+      REQUIRE_FALSE(xs.isInline());
+      REQUIRE(xs.size() == 10);
+      for (int i = 0; i < 10; ++i)
+        REQUIRE(xs[i] == std::to_string(i));
+      REQUIRE(ScratchArena::local().outstanding() == outstanding + 1);
+    }
+    REQUIRE(ScratchArena::local().outstanding() == outstanding);
+  }
+
+  SECTION("moving takes over spilled storage") {
+    InlineBuffer<int, 2> xs{1, 2, 3};
+    const int *data = xs.data();
+    InlineBuffer<int, 2> ys(std::move(xs));
+    REQUIRE(ys.data() == data);
+    REQUIRE(ys.size() == 3);
+    REQUIRE(xs.empty());
+    REQUIRE(xs.isInline());
+  }
+
+  SECTION("copies and moves inline elements") {
+    InlineBuffer<std::string, 4> xs{"a", "b"};
+    InlineBuffer<std::string, 4> copy(xs);
+    InlineBuffer<std::string, 4> moved(std::move(xs));
+    REQUIRE(copy.size() == 2);
+    REQUIRE(moved.size() == 2);
+    REQUIRE(moved[1] == "b");
+    REQUIRE(xs.empty());
+  }
+
+  SECTION("erase keeps the order") {
+    InlineBuffer<int, 4> xs{1, 2, 3, 4};
+    xs.erase(xs.begin() + 1);
+    REQUIRE(xs.size() == 3);
+    REQUIRE(xs[0] == 1);
+    REQUIRE(xs[1] == 3);
+    REQUIRE(xs[2] == 4);
+  }
+
+  SECTION("destroys its elements inline and spilled") {
+    const auto shared = std::make_shared<int>(7);
+    const auto fill = [&](auto &xs, int count) {
+      for (int i = 0; i < count; ++i)
+        xs.push_back(shared);
+    };
+    // 3 stays inline, 10 spills to the scratch arena
+    for (const int count : {3, 10}) {
+      {
+        InlineBuffer<std::shared_ptr<int>, 4> xs;
+        fill(xs, count);
+        REQUIRE(xs.isInline() == (count <= 4));
+        REQUIRE(shared.use_count() == 1 + count);
+
+        xs.erase(xs.begin());
+        REQUIRE(shared.use_count() == count);
+        xs.pop_back();
+        REQUIRE(shared.use_count() == count - 1);
+        xs.clear();
+        REQUIRE(shared.use_count() == 1);
+
+        fill(xs, count);
+        InlineBuffer<std::shared_ptr<int>, 4> moved(std::move(xs));
+        REQUIRE(shared.use_count() == 1 + count);
+        InlineBuffer<std::shared_ptr<int>, 4> assigned;
+        fill(assigned, 2);
+        assigned = std::move(moved);
+        REQUIRE(shared.use_count() == 1 + count);
+        InlineBuffer<std::shared_ptr<int>, 4> copy(assigned);
+        REQUIRE(shared.use_count() == 1 + 2 * count);
+      }
+      REQUIRE(shared.use_count() == 1);
+    }
+  }
+
+  SECTION("inserts its own elements while growing") {
+    const std::string a(40, 'a'), b(40, 'b');
+    InlineBuffer<std::string, 2> xs{a, b};
+    xs.push_back(xs[0]);
+    xs.emplace_back(xs[1]);
+    REQUIRE_FALSE(xs.isInline());
+    REQUIRE(xs.size() == 4);
+    REQUIRE(xs[0] == a);
+    REQUIRE(xs[1] == b);
+    REQUIRE(xs[2] == a);
+    REQUIRE(xs[3] == b);
+
+    // full again, the element is moved from itself into the new storage
+    xs.push_back(std::move(xs[3]));
+    REQUIRE(xs.size() == 5);
+    REQUIRE(xs[4] == b);
+  }
+
+  SECTION("holds intersections beyond the inline capacity") {
+    auto s = std::make_shared<Sphere>();
+    IntersectionBuffer xs;
+    for (int i = 0; i < 20; ++i)
+      xs.emplace_back(float(i), s);
+    REQUIRE(xs.size() == 20);
+    REQUIRE(xs[19].t() == 19.f);
+    REQUIRE(xs[19].object() == s.get());
+  }
+}
+
+TEST_CASE("ScratchArena") {
+  ScratchArena arena;
+
+  SECTION("respects the alignment") {
+    arena.allocate(3, 1);
+    const auto p = reinterpret_cast<uintptr_t>(arena.allocate(8, 64));
+    REQUIRE(p % 64 == 0);
+  }
+
+  SECTION("reuses its blocks once everything was released") {
+    for (int i = 0; i < 3; ++i) {
+      arena.allocate(1000, 8);
+      arena.allocate(100000, 8);
+    }
+    arena.release();
+    arena.release();
+    arena.release();
+    arena.release();
+    arena.release();
+    arena.release();
+    REQUIRE(arena.outstanding() == 0);
+    const size_t reserved = arena.reservedBytes();
+
+    for (int i = 0; i < 3; ++i) {
+      arena.allocate(1000, 8);
+      arena.allocate(100000, 8);
+    }
+    REQUIRE(arena.reservedBytes() == reserved);
+  }
+}
@@ -12,7 +12,9 @@ TEST_CASE("intersection - constructor") {
   const auto s = std::make_shared<Sphere>();
   const auto i = Intersection(3.5, s);
   REQUIRE(i.t() == Approx(3.5));
-  REQUIRE(i.object() == s);
+  REQUIRE(i.object() == s.get());
+  // intersections only refer to the shape, they do not share ownership
+  REQUIRE(s.use_count() == 1);
 }
 
 TEST_CASE("intersection - aggregate") {
@@ -251,3 +251,28 @@ TEST_CASE("matrix - inverse") {
     REQUIRE(c * b.inverse() == a);
   }
 }
+
+TEST_CASE("matrix - affine inverse") {
+  const auto a = Matrix<4, 4>{
+      {2, 0, 1, 3}, {-1, 3, 0, -4}, {0.5, 1, 4, 5}, {0, 0, 0, 1}};
+  REQUIRE(a.isAffine());
+  REQUIRE_FALSE(Matrix<4, 4>{
+      {-5, 2, 6, -8}, {1, -5, 1, 8}, {7, 7, -6, -7}, {1, -3, 7, 4}}
+                    .isAffine());
+
+  // same result as the cofactor expansion
+  Matrix<4, 4> expected;
+  const float invDet = 1.f / a.determinant();
+  for (uint8_t i = 0; i < 4; ++i) {
+    for (uint8_t j = 0; j < 4; ++j) {
+      expected(i, j) = a.cofactor(j, i) * invDet;
+    }
+  }
+  REQUIRE(a.affineInverse() == expected);
+  REQUIRE(a.inverse() == expected);
+  REQUIRE(a * a.inverse() == Mat44::identity());
+
+  const auto singular =
+      Matrix<4, 4>{{1, 2, 3, 0}, {2, 4, 6, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+  REQUIRE_THROWS_AS(singular.inverse(), std::runtime_error);
+}
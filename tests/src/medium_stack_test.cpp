@@ -0,0 +1,43 @@
+#include "medium_stack.h"
+#include "sphere.h"
+#include <catch2/catch.hpp>
+#include <memory>
+
+TEST_CASE("MediumStack") {
+  auto A = std::make_shared<Sphere>(Sphere::GlassSphere());
+  A->material().setReflectiveIndex(1.5);
+  auto B = std::make_shared<Sphere>(Sphere::GlassSphere());
+  B->material().setReflectiveIndex(2.0);
+
+  SECTION("starts in vacuum") {
+    const MediumStack media;
+    REQUIRE(media.empty());
+    REQUIRE(media.refractiveIndex() == 1.f);
+    REQUIRE(media.refractiveIndexAfter(A.get()) == 1.5f);
+  }
+
+  SECTION("crossing a surface enters or leaves the object") {
+    MediumStack media;
+    media.cross(A.get());
+    media.cross(B.get());
+    REQUIRE(media.size() == 2);
+    REQUIRE(media.refractiveIndex() == 2.f);
+    media.cross(B.get());
+    REQUIRE(media.size() == 1);
+    REQUIRE(media.refractiveIndex() == 1.5f);
+    media.cross(A.get());
+    REQUIRE(media.empty());
+  }
+
+  SECTION("leaving an object the ray entered earlier") {
+    MediumStack media;
+    media.cross(A.get());
+    media.cross(B.get());
+    // overlapping objects, A is left while the ray is still inside B
+    REQUIRE(media.refractiveIndexAfter(A.get()) == 2.f);
+    REQUIRE(media.refractiveIndexAfter(B.get()) == 1.5f);
+    media.cross(A.get());
+    REQUIRE_FALSE(media.contains(A.get()));
+    REQUIRE(media.refractiveIndex() == 2.f);
+  }
+}
@@ -0,0 +1,39 @@
+#include "parallel.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("parallelFor()") {
+  SECTION("visits every index exactly once") {
+    constexpr size_t count = 1000;
+    std::vector<std::atomic<int>> visits(count);
+    parallelFor(count, 8, [&](size_t i) { visits[i]++; });
+    for (const auto &v : visits) {
+      REQUIRE(v.load() == 1);
+    }
+  }
+
+  SECTION("more threads than work") {
+    std::vector<std::atomic<int>> visits(3);
+    parallelFor(visits.size(), 16, [&](size_t i) { visits[i]++; });
+    for (const auto &v : visits) {
+      REQUIRE(v.load() == 1);
+    }
+  }
+
+  SECTION("empty range") {
+    bool called = false;
+    parallelFor(0, 4, [&](size_t) { called = true; });
+    REQUIRE_FALSE(called);
+  }
+
+  SECTION("rethrows task exception") {
+    REQUIRE_THROWS_AS(parallelFor(100, 4,
+                                  [](size_t i) {
+                                    if (i == 42)
+                                      throw std::runtime_error("task");
+                                  }),
+                      std::runtime_error);
+  }
+}
@@ -24,6 +24,9 @@ TEST_CASE("pattern - setTransformation()") {
   auto pattern = TestPattern();
   pattern.setTransformation(translation(1, 2, 3));
   REQUIRE(pattern.transformation() == translation(1, 2, 3));
+  REQUIRE(pattern.inverseTransformation() == translation(-1, -2, -3));
+  pattern.transformation() = scaling(2, 2, 2);
+  REQUIRE(pattern.inverseTransformation() == scaling(.5f, .5f, .5f));
 }
 
 TEST_CASE("pattern - colorAtObject") {
@@ -34,7 +34,7 @@ TEST_CASE("plane - intersept") {
     const auto xs = p->intersept(r);
     REQUIRE(xs.size() == 1);
     REQUIRE(xs[0].t() == Approx(1));
-    REQUIRE(xs[0].object() == p);
+    REQUIRE(xs[0].object() == p.get());
   }
 
   SECTION("ray intersecting a plane from below") {
@@ -43,6 +43,23 @@ TEST_CASE("plane - intersept") {
     const auto xs = p->intersept(r);
     REQUIRE(xs.size() == 1);
     REQUIRE(xs[0].t() == Approx(1));
-    REQUIRE(xs[0].object() == p);
+    REQUIRE(xs[0].object() == p.get());
   }
 }
+
+TEST_CASE("plane - bounds()") {
+  const auto p = Plane();
+  const auto box = p.bounds();
+  REQUIRE(box.isInfinite());
+  REQUIRE(box.min.y == 0.f);
+  REQUIRE(box.max.y == 0.f);
+}
+
+TEST_CASE("plane - interseptsBetween()") {
+  const auto p = Plane();
+  const auto r = Ray(Point(0, 1, 0), Vector(0, -1, 0));
+  REQUIRE(p.interseptsBetween(r, 0, 2));
+  REQUIRE_FALSE(p.interseptsBetween(r, 0, 1));
+  REQUIRE_FALSE(p.interseptsBetween(Ray(Point(0, 10, 0), Vector(0, 0, 1)), 0,
+                                    100));
+}
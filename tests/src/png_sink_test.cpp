@@ -0,0 +1,120 @@
+#include "canvas.h"
+#include "encoder_test_utils.h"
+#include "png_sink.h"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+uint32_t crc(const uint8_t *data, size_t size) {
+  uint32_t c = 0xffffffffu;
+  for (size_t i = 0; i < size; ++i) {
+    c ^= data[i];
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    }
+  }
+  return c ^ 0xffffffffu;
+}
+
+struct Chunk {
+  std::string type;
+  std::vector<uint8_t> data;
+};
+
+// splits the file into chunks, checking every CRC
+std::vector<Chunk> chunks(const std::vector<uint8_t> &png) {
+  const std::vector<uint8_t> signature = {0x89, 'P', 'N', 'G',
+                                          '\r', '\n', 0x1a, '\n'};
+  REQUIRE(std::vector<uint8_t>(png.begin(), png.begin() + 8) == signature);
+  std::vector<Chunk> result;
+  for (size_t p = 8; p < png.size();) {
+    const uint32_t size = bigEndian(&png[p]);
+    REQUIRE(p + 12 + size <= png.size());
+    REQUIRE(crc(&png[p + 4], size + 4) == bigEndian(&png[p + 8 + size]));
+    result.push_back({std::string(png.begin() + p + 4, png.begin() + p + 8),
+                      std::vector<uint8_t>(png.begin() + p + 8,
+                                           png.begin() + p + 8 + size)});
+    p += 12 + size;
+  }
+  return result;
+}
+
+// the scanlines of a zlib stream made of stored deflate blocks
+std::vector<uint8_t> inflateStored(const std::vector<uint8_t> &zlib) {
+  REQUIRE(zlib.size() >= 6);
+  REQUIRE((zlib[0] * 256 + zlib[1]) % 31 == 0);
+  std::vector<uint8_t> out;
+  size_t p = 2;
+  bool last = false;
+  while (!last) {
+    last = zlib.at(p) & 1;
+    REQUIRE((zlib.at(p) >> 1) == 0);
+    const uint16_t size = zlib.at(p + 1) | zlib.at(p + 2) << 8;
+    const uint16_t check = zlib.at(p + 3) | zlib.at(p + 4) << 8;
+    REQUIRE(uint16_t(~size) == check);
+    out.insert(out.end(), zlib.begin() + p + 5, zlib.begin() + p + 5 + size);
+    p += 5 + size;
+  }
+
+  uint32_t a = 1, b = 0;
+  for (const uint8_t byte : out) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  REQUIRE(p + 4 == zlib.size());
+  REQUIRE(bigEndian(&zlib[p]) == (b << 16 | a));
+  return out;
+}
+} // namespace
+
+TEST_CASE("PNGSink") {
+  // more than one stored block: 250 rows of 1 + 3 * 101 bytes
+  auto canvas = Canvas(101, 250);
+  for (uint32_t y = 0; y < canvas.height(); ++y) {
+    for (uint32_t x = 0; x < canvas.width(); ++x) {
+      canvas.writePixel(x, y, Color(x / 100.f, y / 249.f, (x ^ y) % 3 / 2.f));
+    }
+  }
+
+  const auto png = encode<PNGSink>(canvas);
+  // a reused sink starts a fresh stream
+  auto twice = png;
+  twice.insert(twice.end(), png.begin(), png.end());
+  REQUIRE(encode<PNGSink>(canvas, 2) == twice);
+
+  const auto all = chunks(png);
+  REQUIRE(all.front().type == "IHDR");
+  const auto &header = all.front().data;
+  REQUIRE(header.size() == 13);
+  REQUIRE(bigEndian(&header[0]) == 101);
+  REQUIRE(bigEndian(&header[4]) == 250);
+  REQUIRE(std::vector<uint8_t>(header.begin() + 8, header.end()) ==
+          std::vector<uint8_t>{8, 2, 0, 0, 0});
+  REQUIRE(all.back().type == "IEND");
+
+  std::vector<uint8_t> zlib;
+  size_t idats = 0;
+  for (const auto &chunk : all) {
+    if (chunk.type == "IDAT") {
+      zlib.insert(zlib.end(), chunk.data.begin(), chunk.data.end());
+      ++idats;
+    }
+  }
+  REQUIRE(idats > 1);
+
+  const auto scanlines = inflateStored(zlib);
+  const size_t rowBytes = 1 + 3 * 101;
+  REQUIRE(scanlines.size() == rowBytes * 250);
+  std::vector<Color> row(101);
+  std::vector<uint8_t> expected(3 * 101);
+  for (uint32_t y = 0; y < 250; ++y) {
+    REQUIRE(scanlines[y * rowBytes] == 0);
+    canvas.readPixels(0, y, row);
+    quantize(row.data(), row.size(), expected.data());
+    REQUIRE(std::vector<uint8_t>(scanlines.begin() + y * rowBytes + 1,
+                                 scanlines.begin() + (y + 1) * rowBytes) ==
+            expected);
+  }
+}
@@ -0,0 +1,100 @@
+#include "canvas.h"
+#include "encoder_test_utils.h"
+#include "qoi_sink.h"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+// reference decoder following the QOI specification, three bytes per pixel
+std::vector<uint8_t> decode(const std::vector<uint8_t> &qoi, size_t pixels) {
+  struct Pixel {
+    uint8_t r{0}, g{0}, b{0}, a{0};
+  };
+  Pixel index[64];
+  Pixel px{0, 0, 0, 255};
+  std::vector<uint8_t> out;
+  size_t p = 14;
+  int run = 0;
+  while (out.size() < pixels * 3) {
+    if (run > 0) {
+      --run;
+    } else {
+      const uint8_t b = qoi.at(p++);
+      if (b == 0xfe) {
+        px.r = qoi.at(p++);
+        px.g = qoi.at(p++);
+        px.b = qoi.at(p++);
+      } else if (b >> 6 == 0) {
+        px = index[b];
+      } else if (b >> 6 == 1) {
+        px.r += ((b >> 4) & 3) - 2;
+        px.g += ((b >> 2) & 3) - 2;
+        px.b += (b & 3) - 2;
+      } else if (b >> 6 == 2) {
+        const uint8_t b2 = qoi.at(p++);
+        const int dg = (b & 63) - 32;
+        px.r += dg - 8 + (b2 >> 4);
+        px.g += dg;
+        px.b += dg - 8 + (b2 & 15);
+      } else {
+        run = b & 63;
+      }
+      index[(px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64] = px;
+    }
+    out.insert(out.end(), {px.r, px.g, px.b});
+  }
+  REQUIRE(qoi.size() == p + 8);
+  return out;
+}
+} // namespace
+
+TEST_CASE("QOISink") {
+  auto canvas = Canvas(67, 13, PixelFormat::SRGB8);
+  for (uint32_t y = 0; y < canvas.height(); ++y) {
+    for (uint32_t x = 0; x < canvas.width(); ++x) {
+      // runs, small and large steps and repeated colors
+      const float r = x < 20 ? .5f : (x % 7) / 6.f;
+      canvas.writePixel(x, y,
+                        Color(r, y / 12.f + x / 600.f, (x * y % 5) / 4.f));
+    }
+  }
+  std::vector<uint8_t> expected(size_t(canvas.width()) * canvas.height() * 3);
+  for (uint32_t y = 0; y < canvas.height(); ++y) {
+    std::vector<Color> row(canvas.width());
+    canvas.readPixels(0, y, row);
+    quantize(row.data(), row.size(), &expected[size_t(y) * row.size() * 3]);
+  }
+
+  const auto qoi = encode<QOISink>(canvas);
+  REQUIRE(std::string(qoi.begin(), qoi.begin() + 4) == "qoif");
+  REQUIRE(bigEndian(&qoi[4]) == 67);
+  REQUIRE(bigEndian(&qoi[8]) == 13);
+  REQUIRE(qoi[12] == 3);
+  REQUIRE(std::vector<uint8_t>(qoi.end() - 8, qoi.end()) ==
+          std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 1});
+  REQUIRE(decode(qoi, 67 * 13) == expected);
+
+  SECTION("a reused sink starts a fresh stream") {
+    auto twice = qoi;
+    twice.insert(twice.end(), qoi.begin(), qoi.end());
+    REQUIRE(encode<QOISink>(canvas, 2) == twice);
+
+    // a stale encoder would continue the run of the previous image's pixel
+    auto red = Canvas(1, 1);
+    red.writePixel(0, 0, Color(1, 0, 0));
+    const auto once = encode<QOISink>(red);
+    twice = once;
+    twice.insert(twice.end(), once.begin(), once.end());
+    REQUIRE(encode<QOISink>(red, 2) == twice);
+  }
+
+  SECTION("a long run is split") {
+    const auto black = encode<QOISink>(Canvas(100, 1));
+    // 62 + 38 pixels equal to the initial black
+    REQUIRE(black.size() == 14 + 2 + 8);
+    REQUIRE(black[14] == (0xc0 | 61));
+    REQUIRE(black[15] == (0xc0 | 37));
+  }
+}
@@ -0,0 +1,111 @@
+#include "plane.h"
+#include "ray.h"
+#include "ray_packet.h"
+#include "sphere.h"
+#include "transformations.h"
+#include "world.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <memory>
+
+TEST_CASE("Float4") {
+  const Float4 a(1, -2, 3, -4);
+  const Float4 b(2.f);
+  REQUIRE((a + b)[1] == 0.f);
+  REQUIRE((a * b)[3] == -8.f);
+  REQUIRE(abs(a)[3] == 4.f);
+  REQUIRE(sqrt(Float4(9.f))[2] == 3.f);
+
+  const Mask4 positive = a > Float4(0.f);
+  REQUIRE(positive[0]);
+  REQUIRE_FALSE(positive[1]);
+  REQUIRE(positive.any());
+  REQUIRE_FALSE((a > Float4(5.f)).any());
+  REQUIRE(select(positive, a, b)[0] == 1.f);
+  REQUIRE(select(positive, a, b)[1] == 2.f);
+}
+
+TEST_CASE("RayPacket") {
+  const Ray rays[4] = {Ray(Point(0, 0, -5), Vector(0, 0, 1)),
+                       Ray(Point(0, 1, -5), Vector(0, 0, 1)),
+                       Ray(Point(0, 2, -5), Vector(0, 0, 1)),
+                       Ray(Point(0, 0, 0), Vector(0, 0, 1))};
+  const RayPacket packet(rays);
+
+  SECTION("lanes") {
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(packet.ray(i).origin() == rays[i].origin());
+      REQUIRE(packet.ray(i).direction() == rays[i].direction());
+    }
+  }
+
+  SECTION("transforming a packet") {
+    const auto m = translation(3, 4, 5) * scaling(2, 3, 4);
+    const auto transformed = packet * m;
+    for (int i = 0; i < 4; ++i) {
+      const Ray expected = rays[i] * m;
+      REQUIRE(transformed.ray(i).origin() == expected.origin());
+      REQUIRE(transformed.ray(i).direction() == expected.direction());
+    }
+  }
+
+  SECTION("sphere hits per lane") {
+    const Sphere s;
+    PacketHit hits;
+    s.localInterseptPacket(packet, hits);
+    REQUIRE(hits.t[0] == 4.f);
+    REQUIRE(hits.t[1] == 5.f);
+    REQUIRE(hits.object[1] == &s);
+    REQUIRE(hits.object[2] == nullptr);
+    REQUIRE(std::isinf(hits.t[2]));
+    // the origin is inside of the sphere, only the far root counts
+    REQUIRE(hits.t[3] == 1.f);
+  }
+
+  SECTION("plane hits per lane") {
+    const Ray down[4] = {Ray(Point(0, 1, 0), Vector(0, -1, 0)),
+                         Ray(Point(0, -1, 0), Vector(0, 1, 0)),
+                         Ray(Point(0, 1, 0), Vector(0, 1, 0)),
+                         Ray(Point(0, 1, 0), Vector(1, 0, 0))};
+    const Plane p;
+    PacketHit hits;
+    p.localInterseptPacket(RayPacket(down), hits);
+    REQUIRE(hits.t[0] == 1.f);
+    REQUIRE(hits.t[1] == 1.f);
+    REQUIRE(hits.object[2] == nullptr);
+    REQUIRE(hits.object[3] == nullptr);
+  }
+
+  SECTION("closest hits match single rays") {
+    auto w = World::defaultWorld();
+    auto floor = std::make_shared<Plane>();
+    floor->setTransformation(translation(0, -1, 0));
+    w.addObject(floor);
+    for (int i = 0; i < 5; ++i) {
+      auto s = std::make_shared<Sphere>();
+      s->setTransformation(translation(i - 2.f, 0.5f, 2.f) *
+                           scaling(0.4f, 0.4f, 0.4f));
+      w.addObject(s);
+    }
+
+    for (int y = -4; y < 4; ++y) {
+      for (int x = -4; x < 4; x += 4) {
+        const Ray lanes[4] = {
+            Ray(Point(0, 0, -5), Vector(x * .1f, y * .1f, 1).normalize()),
+            Ray(Point(0, 0, -5), Vector((x + 1) * .1f, y * .1f, 1).normalize()),
+            Ray(Point(0, 0, -5), Vector((x + 2) * .1f, y * .1f, 1).normalize()),
+            Ray(Point(0, 0, -5),
+                Vector((x + 3) * .1f, y * .1f, 1).normalize())};
+        const auto hits = RayPacket(lanes).closestHits(w);
+        for (int i = 0; i < 4; ++i) {
+          const auto expected = lanes[i].closestHit(w);
+          REQUIRE(expected.has_value() == (hits.object[i] != nullptr));
+          if (expected) {
+            REQUIRE(hits.t[i] == expected->t());
+            REQUIRE(hits.object[i] == expected->object());
+          }
+        }
+      }
+    }
+  }
+}
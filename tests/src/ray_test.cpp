@@ -74,8 +74,8 @@ TEST_CASE("ray - intersept") {
     const auto s = std::make_shared<Sphere>();
     const auto xs = r.intersept(s);
     REQUIRE(xs.size() == 2);
-    REQUIRE(xs[0].object() == s);
-    REQUIRE(xs[1].object() == s);
+    REQUIRE(xs[0].object() == s.get());
+    REQUIRE(xs[1].object() == s.get());
   }
 
   SECTION("with scaled sphere") {
@@ -194,6 +194,27 @@ TEST_CASE("ray - precompute") {
     REQUIRE(comps.n2 == Approx(expected_n2));
   }
 
+  SECTION("n1 and n2 from the media the ray travels through") {
+    auto A = std::make_shared<Sphere>(Sphere::GlassSphere());
+    A->transformation() = scaling(2, 2, 2);
+    A->material().setReflectiveIndex(1.5);
+    auto B = std::make_shared<Sphere>(Sphere::GlassSphere());
+    B->material().setReflectiveIndex(2.0);
+    const auto r = Ray(Point(0, 0, -4), Vector(0, 0, 1));
+
+    MediumStack media;
+    media.cross(A.get());
+    const auto entering = r.precompute(Intersection(3, B), media);
+    REQUIRE(entering.n1 == Approx(1.5));
+    REQUIRE(entering.n2 == Approx(2.0));
+    REQUIRE(entering.media.contains(A.get()));
+
+    media.cross(B.get());
+    const auto leavingOuter = r.precompute(Intersection(6, A), media);
+    REQUIRE(leavingOuter.n1 == Approx(2.0));
+    REQUIRE(leavingOuter.n2 == Approx(2.0));
+  }
+
   SECTION("computing under point") {
     const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
     auto shape = std::make_shared<Sphere>(Sphere::GlassSphere());
@@ -205,3 +226,46 @@ TEST_CASE("ray - precompute") {
     REQUIRE(comps.point.z < comps.underPoint.z);
   }
 }
+
+TEST_CASE("ray - closestHit()") {
+  SECTION("matches hit() of the full intersection list") {
+    const auto w = World::defaultWorld();
+    const Ray rays[] = {Ray(Point(0, 0, -5), Vector(0, 0, 1)),
+                        Ray(Point(0, 0, 0), Vector(0, 0, 1)),
+                        Ray(Point(0, 0, 0.75), Vector(0, 0, -1)),
+                        Ray(Point(0, .9f, -5), Vector(0, 0, 1))};
+    for (const auto &r : rays) {
+      const auto expected = hit(r.intersept(w));
+      const auto h = r.closestHit(w);
+      REQUIRE(h.has_value());
+      REQUIRE(h->t() == expected->t());
+      REQUIRE(h->object() == expected->object());
+    }
+  }
+
+  SECTION("nearest of several objects") {
+    auto w = World();
+    auto floor = std::make_shared<Plane>();
+    floor->setTransformation(translation(0, -1, 0));
+    w.addObject(floor);
+    auto s = std::make_shared<Sphere>();
+    s->setTransformation(translation(0, 0, 10));
+    w.addObject(s);
+    const auto h = Ray(Point(0, 0, 0), Vector(0, -.1f, 1).normalize())
+                       .closestHit(w);
+    REQUIRE(h.has_value());
+    REQUIRE(h->object() == s.get());
+  }
+
+  SECTION("all intersections behind the ray") {
+    const auto w = World::defaultWorld();
+    const auto r = Ray(Point(0, 0, 5), Vector(0, 0, 1));
+    REQUIRE_FALSE(r.closestHit(w).has_value());
+  }
+
+  SECTION("ray misses") {
+    const auto w = World::defaultWorld();
+    const auto r = Ray(Point(0, 0, -5), Vector(0, 1, 0));
+    REQUIRE_FALSE(r.closestHit(w).has_value());
+  }
+}
@@ -0,0 +1,162 @@
+#include "pattern.h"
+#include "plane.h"
+#include "scene.h"
+#include "sphere.h"
+#include "transformations.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+namespace {
+// the default world of World::defaultWorld() seen by a small camera
+const char *s_defaultWorld = R"(
+  # comments run to the end of the line
+  camera{width 11 height 11 fov 90 from 0 0 -5 to 0 0 0 up 0 1 0}
+  light { position -10 10 -10 }
+  sphere {
+    material { color .8 1 .6 diffuse .7 specular .2 }
+  }
+  sphere { transform { scale .5 .5 .5 } }
+)";
+} // namespace
+
+TEST_CASE("scene - parseScene()") {
+  SECTION("renders like the world built in code") {
+    const auto scene = parseScene(s_defaultWorld);
+    REQUIRE(scene.world.objects().size() == 2);
+    REQUIRE(scene.world.lights().size() == 1);
+    REQUIRE(scene.world.lights()[0] ==
+            PointLight(Point(-10, 10, -10), Color(1, 1, 1)));
+    REQUIRE(scene.camera.hsize() == 11);
+    REQUIRE(scene.camera.vsize() == 11);
+
+    auto c = Camera(11, 11, M_PI / 2);
+    c.setTransorm(view(Point(0, 0, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+    const auto expected = c.render(World::defaultWorld());
+    const auto image = scene.camera.render(scene.world);
+    for (uint32_t y = 0; y < 11; ++y) {
+      for (uint32_t x = 0; x < 11; ++x) {
+        REQUIRE(image(x, y) == expected(x, y));
+      }
+    }
+  }
+
+  SECTION("shapes, transforms and materials") {
+    const auto scene = parseScene(R"(
+      camera { width 4 height 2 fov 60 }
+      plane {
+        transform { translate 1 2 3 rotate-z 90 scale 2 2 2 }
+        material {
+          ambient .2 diffuse .5 specular .4 shininess 50 reflective .3
+          transparency .8 refractive-index 1.5
+        }
+        shadow false
+      }
+      sphere { transform { shear 1 0 0 0 0 0 } }
+    )");
+    const auto &objects = scene.world.objects();
+    REQUIRE(objects.size() == 2);
+    REQUIRE(std::dynamic_pointer_cast<Plane>(objects[0]));
+    REQUIRE(std::dynamic_pointer_cast<Sphere>(objects[1]));
+    REQUIRE(objects[0]->transformation() == translation(1, 2, 3) *
+                                                rotationZ(M_PI / 2) *
+                                                scaling(2, 2, 2));
+    REQUIRE(objects[1]->transformation() == shearing(1, 0, 0, 0, 0, 0));
+    REQUIRE_FALSE(objects[0]->castShadows());
+    REQUIRE(objects[1]->castShadows());
+
+    const auto &m = objects[0]->material();
+    REQUIRE(m.ambient() == .2f);
+    REQUIRE(m.diffuse() == .5f);
+    REQUIRE(m.specular() == .4f);
+    REQUIRE(m.shiness() == 50.f);
+    REQUIRE(m.reflective() == .3f);
+    REQUIRE(m.transparency() == .8f);
+    REQUIRE(m.reflectiveIndex() == 1.5f);
+    REQUIRE(objects[1]->material() == Material());
+  }
+
+  SECTION("pattern trees") {
+    const auto scene = parseScene(R"(
+      camera { width 1 height 1 fov 60 }
+      sphere {
+        material {
+          pattern checker {
+            a stripe { a 1 1 1 b 0 0 0 transform { scale .5 1 1 } }
+            b perlin { pattern ring { a 1 0 0 b 0 1 0 } }
+            transform { rotate-y 45 }
+          }
+        }
+      }
+    )");
+    const auto &root = scene.world.objects()[0]->material().pattern();
+    const auto checker = std::dynamic_pointer_cast<CheckerPattern>(root);
+    REQUIRE(checker);
+    REQUIRE(checker->transformation() == rotationY(M_PI / 4));
+
+    auto stripe = std::make_shared<StripePattern>(Color(1, 1, 1),
+                                                  Color(0, 0, 0));
+    stripe->setTransformation(scaling(.5f, 1, 1));
+    auto ring = std::make_shared<RingPattern>(Color(1, 0, 0), Color(0, 1, 0));
+    auto expected = std::make_shared<CheckerPattern>(
+        stripe, std::make_shared<PerlinNoisePattern>(ring));
+    expected->setTransformation(rotationY(M_PI / 4));
+    for (float x = -2.f; x < 2.f; x += .37f) {
+      const auto p = Point(x, .1f, -x * .5f);
+      REQUIRE(root->colorAt(p) == expected->colorAt(p));
+    }
+
+    const Color white(1, 1, 1), black(0, 0, 0);
+    for (const auto &[kind, expected] :
+         {std::pair<std::string, PatternPtr>{
+              "stripe", std::make_shared<StripePattern>(white, black)},
+          {"gradient", std::make_shared<GradientPattern>(white, black)},
+          {"ring", std::make_shared<RingPattern>(white, black)},
+          {"checker", std::make_shared<CheckerPattern>(white, black)},
+          {"radial-gradient",
+           std::make_shared<RadialGradientPattern>(white, black)},
+          {"blend", std::make_shared<BlendPattern>(white, black)}}) {
+      const auto text = "camera { width 1 height 1 fov 60 }"
+                        "sphere { material { pattern " +
+                        kind + " { a 1 1 1 b 0 0 0 } } }";
+      const auto pattern =
+          parseScene(text).world.objects()[0]->material().pattern();
+      REQUIRE(typeid(*pattern) == typeid(*expected));
+      for (float x = -2.f; x < 2.f; x += .37f) {
+        const auto p = Point(x, .1f, -x * .5f);
+        REQUIRE(pattern->colorAt(p) == expected->colorAt(p));
+      }
+    }
+  }
+
+  SECTION("errors name the line") {
+    const std::string camera = "camera { width 1 height 1 fov 60 }\n";
+    for (const auto &[text, line] :
+         {std::pair{std::string("sphere { material { color 1 x 1 } }"), 1},
+          {camera + "\nsphere {\n  transform { scale 0 1 1 }\n}", 4},
+          {camera + "cube { }", 2},
+          {camera + "sphere { material { pattern dots { } } }", 2},
+          {camera + "sphere { material { pattern stripe { a 1 1 1 } } }", 2},
+          {camera + "sphere { shadow maybe }", 2},
+          {camera + "light { intensity 1 1 1 }", 2},
+          {camera + "sphere {", 2},
+          {std::string("camera { width 1 height 1 }"), 1},
+          {std::string("sphere { }"), 1}}) {
+      try {
+        parseScene(text);
+        FAIL("no error for: " << text);
+      } catch (const std::runtime_error &e) {
+        const std::string prefix = "scene line " + std::to_string(line) + ":";
+        REQUIRE(std::string(e.what()).substr(0, prefix.size()) == prefix);
+      }
+    }
+  }
+
+  SECTION("loadScene() reports missing files") {
+    REQUIRE_THROWS_AS(loadScene("/nonexistent/scene.txt"), std::runtime_error);
+  }
+}
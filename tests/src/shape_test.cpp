@@ -2,6 +2,7 @@
 #include "material.h"
 #include "ray.h"
 #include "shape.h"
+#include "sphere.h"
 #include "transformations.h"
 #include "tuple.h"
 #include <catch2/catch.hpp>
@@ -14,9 +15,8 @@ class TestShape : public Shape {
 public:
   TestShape() : Shape(), localRay_(Ray(Point(0, 0, 0), Vector(0, 0, 1))) {}
 
-  std::vector<Intersection> intersept(const Ray &ray) const override {
+  void localIntersept(const Ray &ray, IntersectionBuffer &) const override {
     localRay_ = ray;
-    return {};
   }
 
   vector_t localNormalsAt(const point_t &p) const override {
@@ -40,6 +40,40 @@ TEST_CASE("shape - transformation") {
     s->setTransformation(t);
     REQUIRE(s->transformation() == t);
   }
+
+  SECTION("cached inverse follows setTransformation()") {
+    const auto s = std::make_shared<TestShape>();
+    s->setTransformation(translation(2, 3, 4));
+    REQUIRE(s->inverseTransformation() == translation(-2, -3, -4));
+    s->setTransformation(scaling(2, 4, 8));
+    REQUIRE(s->inverseTransformation() == scaling(.5f, .25f, .125f));
+    REQUIRE(s->inverseTransposeTransformation() ==
+            scaling(.5f, .25f, .125f).transpose());
+  }
+
+  SECTION("cached inverse follows mutable transformation()") {
+    const auto s = std::make_shared<TestShape>();
+    REQUIRE(s->inverseTransformation() == Mat44::identity());
+    auto &transformation = s->transformation();
+    transformation = translation(1, 0, 0) * scaling(2, 2, 2);
+    REQUIRE(s->inverseTransformation() == transformation.inverse());
+    REQUIRE(s->inverseTransposeTransformation() ==
+            transformation.inverse().transpose());
+  }
+
+  SECTION("uniform scale of similarity transformations") {
+    const auto s = std::make_shared<TestShape>();
+    REQUIRE(s->uniformScale() == 1.f);
+    s->setTransformation(translation(1, 2, 3) * rotationZ(M_PI / 5) *
+                         scaling(2, 2, 2));
+    REQUIRE(s->uniformScale() == Approx(2.f));
+    s->setTransformation(scaling(-.5f, .5f, .5f));
+    REQUIRE(s->uniformScale() == Approx(.5f));
+    s->setTransformation(scaling(1, .5f, 1));
+    REQUIRE(s->uniformScale() == 0.f);
+    s->setTransformation(shearing(1, 0, 0, 0, 0, 0));
+    REQUIRE(s->uniformScale() == 0.f);
+  }
 }
 
 TEST_CASE("shape - default material") {
@@ -91,3 +125,29 @@ TEST_CASE("shape - normalsAt()") {
     REQUIRE(n == Vector(0, 0.97014, -0.24254));
   }
 }
+
+TEST_CASE("shape - bounds()") {
+  SECTION("unbounded by default") {
+    const auto s = std::make_shared<TestShape>();
+    REQUIRE_FALSE(s->isBounded());
+    REQUIRE(s->bounds().isInfinite());
+    REQUIRE(s->worldBounds().isInfinite());
+  }
+
+  SECTION("world bounds follow setTransformation()") {
+    auto s = std::make_shared<Sphere>();
+    REQUIRE(s->isBounded());
+    REQUIRE(s->worldBounds().min == Point(-1, -1, -1));
+    s->setTransformation(translation(1, -3, 5) * scaling(.5f, 2, 4));
+    REQUIRE(s->worldBounds().min == Point(.5f, -5, 1));
+    REQUIRE(s->worldBounds().max == Point(1.5f, -1, 9));
+  }
+
+  SECTION("world bounds follow mutable transformation()") {
+    auto s = std::make_shared<Sphere>();
+    REQUIRE(s->worldBounds().max == Point(1, 1, 1));
+    s->transformation() = translation(10, 0, 0);
+    REQUIRE(s->worldBounds().min == Point(9, -1, -1));
+    REQUIRE(s->worldBounds().max == Point(11, 1, 1));
+  }
+}
@@ -0,0 +1,104 @@
+#include "plane.h"
+#include "ray.h"
+#include "sphere.h"
+#include "sphere_block.h"
+#include "transformations.h"
+#include "world.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+// every second sphere is scaled uniformly when mixed is set, so the block
+// uses both its world space and object space lanes
+std::vector<std::shared_ptr<Sphere>> sphereRow(int n, bool mixed = false) {
+  std::vector<std::shared_ptr<Sphere>> spheres;
+  for (int i = 0; i < n; ++i) {
+    auto s = std::make_shared<Sphere>();
+    const float sy = mixed && i % 2 ? .5f : .7f;
+    s->setTransformation(translation(i * 1.5f - 4.f, 0, i % 3) *
+                         scaling(.5f, sy, .5f));
+    spheres.push_back(s);
+  }
+  return spheres;
+}
+} // namespace
+
+TEST_CASE("SphereBlock") {
+  const bool mixed = GENERATE(false, true);
+  const auto spheres = sphereRow(7, mixed);
+  SphereBlock block;
+  for (const auto &s : spheres) {
+    block.add(s.get());
+  }
+  REQUIRE(block.size() == 7);
+  REQUIRE_FALSE(block.full());
+
+  SECTION("closest hit matches the spheres one by one") {
+    for (int i = -6; i <= 6; ++i) {
+      const auto r =
+          Ray(Point(0, 0, -5), Vector(i * .15f, 0.01f * i, 1).normalize());
+      float expectedT = std::numeric_limits<float>::infinity();
+      const Shape *expected = nullptr;
+      for (const auto &s : spheres) {
+        for (const auto &x : r.intersept(s)) {
+          if (x.t() > 0.f && x.t() < expectedT) {
+            expectedT = x.t();
+            expected = s.get();
+          }
+        }
+      }
+
+      float t = std::numeric_limits<float>::infinity();
+      const Shape *object = nullptr;
+      block.closestHit(r, t, object);
+      REQUIRE(object == expected);
+      if (expected) {
+        REQUIRE(t == expectedT);
+      }
+    }
+  }
+
+  SECTION("hits beyond tMax are ignored") {
+    const auto r = Ray(Point(-4, 0, -5), Vector(0, 0, 1));
+    float t = 1.f;
+    const Shape *object = nullptr;
+    block.closestHit(r, t, object);
+    REQUIRE(object == nullptr);
+    REQUIRE(t == 1.f);
+  }
+
+  SECTION("occlusion skips spheres that cast no shadow") {
+    const auto r = Ray(Point(-4, 0, -5), Vector(0, 0, 1));
+    REQUIRE(block.interseptsBetween(r, 0.f, 10.f));
+    REQUIRE_FALSE(block.interseptsBetween(r, 0.f, 4.f));
+
+    spheres[0]->setCastsShadows(false);
+    SphereBlock noShadow;
+    noShadow.add(spheres[0].get());
+    REQUIRE_FALSE(noShadow.interseptsBetween(r, 0.f, 10.f));
+  }
+}
+
+TEST_CASE("bvh - sphere blocks") {
+  World w;
+  for (const auto &s : sphereRow(6)) {
+    w.addObject(s);
+  }
+  w.addObject(std::make_shared<Plane>());
+
+  const auto &bvh = w.bvh();
+  REQUIRE_FALSE(bvh.blocks().empty());
+  size_t packed = 0;
+  for (const auto &block : bvh.blocks()) {
+    packed += block.size();
+  }
+  REQUIRE(packed == 6);
+
+  const auto r = Ray(Point(-2.5f, 0, -5), Vector(0, 0, 1));
+  const auto h = r.closestHit(w);
+  REQUIRE(h.has_value());
+  REQUIRE(h->t() == hit(r.intersept(w))->t());
+}
@@ -1,7 +1,9 @@
+#include "ray.h"
 #include "transformations.h"
 #include "tuple.h"
 #include <catch2/catch.hpp>
 #include <cmath>
+#include <memory>
 #include <sphere.h>
 
 TEST_CASE("sphere - normalsAt") {
@@ -58,3 +60,52 @@ TEST_CASE("glass sphere") {
   REQUIRE(s.material().transparency() == Approx(1.f));
   REQUIRE(s.material().reflectiveIndex() == Approx(1.5f));
 }
+
+TEST_CASE("sphere - bounds()") {
+  const auto s = Sphere();
+  const auto box = s.bounds();
+  REQUIRE(box.min == Point(-1, -1, -1));
+  REQUIRE(box.max == Point(1, 1, 1));
+}
+
+TEST_CASE("sphere - interseptsBetween()") {
+  const auto s = Sphere();
+  const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
+  REQUIRE(s.interseptsBetween(r, 0, 10));
+  REQUIRE(s.interseptsBetween(r, 4.5f, 10));
+  REQUIRE_FALSE(s.interseptsBetween(r, 0, 4));
+  REQUIRE_FALSE(s.interseptsBetween(r, 6, 10));
+  REQUIRE_FALSE(
+      s.interseptsBetween(Ray(Point(0, 2, -5), Vector(0, 0, 1)), 0, 10));
+}
+
+TEST_CASE("sphere - world space intersection") {
+  // similarity transformations take the world space path, the others the
+  // object space one; both have to agree with the transformed ray
+  const Mat44 transformations[] = {
+      translation(1, 2, 3) * scaling(2, 2, 2),
+      translation(-1, 0, 1) * rotationY(M_PI / 3) * scaling(.5f, .5f, .5f),
+      translation(0, 1, 0) * scaling(1, .5f, 2)};
+  const auto r = Ray(Point(-.3f, .4f, -10), Vector(.05f, .1f, 1).normalize());
+
+  for (const auto &m : transformations) {
+    auto s = std::make_shared<Sphere>();
+    s->setTransformation(m);
+    const auto expected = s->intersept(r * s->inverseTransformation());
+    const auto xs = r.intersept(s);
+    REQUIRE(xs.size() == expected.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      REQUIRE(xs[i].t() == Approx(expected[i].t()));
+    }
+    REQUIRE(s->worldInterseptsBetween(r, 0, 20) ==
+            s->interseptsBetween(r * s->inverseTransformation(), 0, 20));
+  }
+
+  SECTION("normal of a uniformly scaled sphere") {
+    auto s = Sphere();
+    s.setTransformation(translation(0, 1, 0) * rotationZ(M_PI / 5) *
+                        scaling(2, 2, 2));
+    const auto n = s.normalsAt(Point(0, 1 + std::sqrt(2), -std::sqrt(2)));
+    REQUIRE(n == Vector(0, 0.70711f, -0.70711f));
+  }
+}
@@ -201,3 +201,28 @@ TEST_CASE("view matrix") {
                        {0.00000, 0.00000, 0.00000, 1.00000}});
   }
 }
+
+TEST_CASE("transformPoint() and transformVector()") {
+  const auto m = translation(1, -2, 3) * rotationY(M_PI / 3) *
+                 shearing(1, 0, 0, 2, 0, 0) * scaling(2, 3, 4);
+
+  SECTION("points match the full product") {
+    const auto p = Point(-3, 4, 5);
+    REQUIRE(m.transformPoint(p) == m * p);
+    REQUIRE(m.transformPoint(p).isPoint());
+  }
+
+  SECTION("vectors ignore the translation") {
+    const auto v = Vector(-3, 4, 5);
+    REQUIRE(m.transformVector(v) == m * v);
+    REQUIRE(translation(5, -3, 2).transformVector(v) == v);
+  }
+
+  SECTION("inverse-transpose keeps normals as vectors") {
+    const auto t = m.inverse().transpose();
+    const auto n = t.transformVector(Vector(0, 1, 0));
+    REQUIRE(n.isVector());
+    const auto full = t * Vector(0, 1, 0);
+    REQUIRE(n == Vector(full.x, full.y, full.z));
+  }
+}
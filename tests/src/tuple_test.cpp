@@ -2,6 +2,7 @@
 #include "tuple.h"
 #include <catch2/catch.hpp>
 #include <cmath>
+#include <cstdint>
 
 TEST_CASE("tuple - Initialization") {
   SECTION("A tuple with w=1.0 is a point") {
@@ -142,6 +143,14 @@ TEST_CASE("tuple - Cross product") {
   const auto v2 = Vector(2, 3, 4);
   REQUIRE(crossProduct(v1, v2) == Vector(-1, 2, -1));
   REQUIRE(crossProduct(v2, v1) == Vector(1, -2, 1));
+  REQUIRE(crossProduct(v1, v2).isVector());
+}
+
+TEST_CASE("tuple - layout") {
+  STATIC_REQUIRE(alignof(Tuple) == 16);
+  STATIC_REQUIRE(sizeof(Tuple) == 16);
+  const Tuple tuples[2] = {Point(1, 2, 3), Vector(4, 5, 6)};
+  REQUIRE(reinterpret_cast<uintptr_t>(&tuples[1]) % 16 == 0);
 }
 
 TEST_CASE("tuple - reflect") {
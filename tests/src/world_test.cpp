@@ -47,6 +47,19 @@ TEST_CASE("world - defaultWorld()") {
   REQUIRE(w.containsObject(s2));
 }
 
+TEST_CASE("world - bounds()") {
+  auto w = World::defaultWorld();
+  auto floor = std::make_shared<Plane>();
+  w.addObject(floor);
+  auto s = std::make_shared<Sphere>();
+  s->setTransformation(translation(4, 0, 0));
+  w.addObject(s);
+  const auto box = w.bounds();
+  REQUIRE(box.min == Point(-1, -1, -1));
+  REQUIRE(box.max == Point(5, 1, 1));
+  REQUIRE(World().bounds().isEmpty());
+}
+
 TEST_CASE("world - ray.intersect()") {
   const auto w = World::defaultWorld();
   const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
@@ -150,6 +163,45 @@ TEST_CASE("world - shadeHit()") {
   }
 }
 
+TEST_CASE("world - shadeHit() with several lights") {
+  SECTION("contributions of the lights add up") {
+    auto w = World::defaultWorld();
+    w.addLight(w.lights()[0]);
+    const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
+    const auto comps = r.precompute(Intersection(4, w.objects()[0]));
+    REQUIRE(w.shadeHit(comps) == Color(0.38066, 0.47583, 0.2855) * 2.f);
+  }
+
+  SECTION("every light is shadowed separately") {
+    auto w = World();
+    w.addLight(PointLight(Point(0, 0, -10), Color(1, 1, 1)));
+    w.addLight(PointLight(Point(0, 10, 10), Color(1, 1, 1)));
+    const auto s1 = std::make_shared<Sphere>();
+    w.addObject(s1);
+    auto s2 = std::make_shared<Sphere>();
+    s2->setTransformation(translation(0, 0, 10));
+    w.addObject(s2);
+    const auto p = Point(0, 0, 8.9f);
+    REQUIRE(w.isShadowed(p, w.lights()[0]));
+    REQUIRE_FALSE(w.isShadowed(p, w.lights()[1]));
+  }
+
+  SECTION("secondary rays are traced once") {
+    auto w = World::defaultWorld();
+    auto shape = std::make_shared<Plane>();
+    shape->material().setReflective(0.5f);
+    shape->transformation() = translation(0, -1, 0);
+    w.addObject(shape);
+    // a black light adds nothing but would double the reflection if the
+    // reflected color was accumulated per light
+    w.addLight(PointLight(Point(10, 10, -10), Color(0, 0, 0)));
+    const auto r =
+        Ray(Point(0, 0, -3), Vector(0, -std::sqrt(2) / 2, std::sqrt(2) / 2));
+    const auto comps = r.precompute(Intersection(std::sqrt(2), shape));
+    REQUIRE(w.shadeHit(comps) == Color(0.87677, 0.92436, 0.82918));
+  }
+}
+
 TEST_CASE("world - colorAt()") {
   SECTION("ray misses") {
     const auto w = World::defaultWorld();
@@ -176,6 +228,37 @@ TEST_CASE("world - colorAt()") {
     REQUIRE(c == inner->material().color());
   }
 
+  SECTION("shapes changed after the first call") {
+    const auto w = World::defaultWorld();
+    const auto outer = w.objects()[0];
+    const auto inner = w.objects()[1];
+    const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
+    REQUIRE(w.colorAt(r) == Color(0.38066, 0.47583, 0.2855));
+
+    outer->setTransformation(translation(100, 0, 0));
+    inner->setTransformation(translation(100, 0, 0));
+    REQUIRE(w.colorAt(r) == Color(0, 0, 0));
+
+    inner->transformation() = scaling(.5f, .5f, .5f);
+    REQUIRE(w.colorAt(r) != Color(0, 0, 0));
+  }
+
+  SECTION("shape moved after prepare()") {
+    const auto w = World::defaultWorld();
+    const auto r = Ray(Point(0, 0, -5), Vector(0, 0, 1));
+    w.prepare();
+    REQUIRE(w.colorAt(r) == Color(0.38066, 0.47583, 0.2855));
+
+    // the outer sphere leaves the ray, the inner one is hit instead
+    w.objects()[0]->setTransformation(translation(0, 100, 0));
+    w.prepare();
+    const auto hit = r.closestHit(w);
+    REQUIRE(hit);
+    REQUIRE(hit->object() == w.objects()[1].get());
+    REQUIRE(hit->t() == Approx(4.5f));
+    REQUIRE(w.colorAt(r) != Color(0.38066, 0.47583, 0.2855));
+  }
+
   SECTION("colorAt() terminates succesfully") {
     auto w = World();
     w.addLight(PointLight(Point(0, 0, 0), Color(1, 1, 1)));
@@ -216,6 +299,30 @@ TEST_CASE("world - isShadowed()") {
     const auto p = Point(-2, 2, -2);
     REQUIRE_FALSE(w.isShadowed(p));
   }
+
+  SECTION("objects that do not cast shadows are skipped") {
+    // changed through the held pointers, the world is not told about it
+    const auto w = World::defaultWorld();
+    const auto outer = w.objects()[0];
+    const auto inner = w.objects()[1];
+    const auto p = Point(10, -10, 10);
+    REQUIRE(w.isShadowed(p));
+    outer->setCastsShadows(false);
+    inner->setCastsShadows(false);
+    REQUIRE_FALSE(w.isShadowed(p));
+    inner->setCastsShadows(true);
+    REQUIRE(w.isShadowed(p));
+  }
+
+  SECTION("object moved between point and light") {
+    const auto w = World::defaultWorld();
+    const auto p = Point(0, 10, 0);
+    REQUIRE_FALSE(w.isShadowed(p));
+    w.objects()[1]->setTransformation(translation(-5, 10, -5));
+    REQUIRE(w.isShadowed(p));
+    w.prepare();
+    REQUIRE(w.isShadowed(p));
+  }
 }
 
 TEST_CASE("world - reflectedColor()") {